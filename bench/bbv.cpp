@@ -0,0 +1,123 @@
+/*********************************************************************
+ * Filename :    bbv.cpp
+ *
+ * Description:  Basic-block vectors for SimPoint. pcore_tb.sv splits the
+ *               retired instructions into basic blocks and passes each
+ *               executed block with its start PC and length. Every
+ *               +bbv_interval=<N> instructions (default 10000000) the
+ *               instructions executed in each block are written to
+ *               +bbv=<file> in the SimPoint frequency vector format. The
+ *               start cycle of every interval is written to
+ *               <file>.intervals, it can be given as +save_cycle to take
+ *               a checkpoint at a simulation point
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define BBV_DEFAULT_INTERVAL 10000000
+
+static bool                                  bbv_on = false;
+static FILE                                 *bbv_fp = NULL;
+static FILE                                 *bbv_intervals_fp = NULL;
+static uint64_t                              bbv_interval = BBV_DEFAULT_INTERVAL;
+
+// Block ids start at 1 in the order the blocks are first executed
+static std::unordered_map<uint32_t, uint32_t> bbv_ids;
+static std::unordered_map<uint32_t, uint64_t> bbv_counts;
+
+static uint64_t                              bbv_instret = 0;
+static uint64_t                              bbv_interval_instret = 0;
+static uint64_t                              bbv_interval_cycle = 0;
+static uint64_t                              bbv_written = 0;
+
+int bbv_enabled() {
+  const char *arg = Verilated::commandArgsPlusMatch("bbv=");
+  if (!arg[0])
+    return 0;
+  arg += 5;
+  if (!strcmp(arg, "0"))
+    return 0;
+
+  const char *arg_interval = Verilated::commandArgsPlusMatch("bbv_interval=");
+  if (arg_interval[0]) {
+    bbv_interval = strtoull(arg_interval + 14, NULL, 0);
+    if (!bbv_interval) {
+      printf("+bbv_interval must be at least 1\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  std::string intervals = std::string(arg) + ".intervals";
+  bbv_fp           = fopen(arg, "w");
+  bbv_intervals_fp = fopen(intervals.c_str(), "w");
+  if (!bbv_fp || !bbv_intervals_fp) {
+    printf("Cannot create basic-block vectors %s\n", arg);
+    exit(EXIT_FAILURE);
+  }
+  fprintf(bbv_intervals_fp, "# interval cycle instret\n");
+  printf("Writing basic-block vectors to %s every %lu instructions\n", arg, (unsigned long)bbv_interval);
+
+  bbv_on = true;
+  return 1;
+}
+
+// One line per interval, the blocks in the order of their ids
+static void bbv_write_interval() {
+  std::vector<std::pair<uint32_t, uint64_t>> counts;
+  for (auto &block : bbv_counts)
+    counts.push_back({ bbv_ids[block.first], block.second });
+  std::sort(counts.begin(), counts.end());
+
+  fprintf(bbv_fp, "T");
+  for (auto &count : counts)
+    fprintf(bbv_fp, ":%u:%lu ", count.first, (unsigned long)count.second);
+  fprintf(bbv_fp, "\n");
+  fprintf(bbv_intervals_fp, "%lu %lu %lu\n", (unsigned long)bbv_written,
+          (unsigned long)bbv_interval_cycle, (unsigned long)bbv_interval_instret);
+
+  bbv_counts.clear();
+  bbv_written++;
+}
+
+// Intervals end at the block that reaches the interval size, as with the
+// Valgrind exp-bbv tool
+void bbv_block(long long cycle, int pc, int count) {
+  if (bbv_counts.empty()) {
+    bbv_interval_cycle   = cycle;
+    bbv_interval_instret = bbv_instret;
+  }
+
+  if (bbv_ids.find((uint32_t)pc) == bbv_ids.end()) {
+    uint32_t id = bbv_ids.size() + 1;
+    bbv_ids[(uint32_t)pc] = id;
+  }
+  bbv_counts[(uint32_t)pc] += count;
+
+  bbv_instret += count;
+  if (bbv_instret - bbv_interval_instret >= bbv_interval)
+    bbv_write_interval();
+}
+
+void bbv_close() {
+  if (!bbv_on)
+    return;
+  bbv_on = false;
+
+  // The last, partial interval is kept so that its instructions are covered
+  if (!bbv_counts.empty())
+    bbv_write_interval();
+  fclose(bbv_fp);
+  fclose(bbv_intervals_fp);
+
+  printf("Basic-block vectors: %lu intervals, %lu blocks, %lu instructions\n",
+         (unsigned long)bbv_written, (unsigned long)bbv_ids.size(), (unsigned long)bbv_instret);
+}
@@ -0,0 +1,222 @@
+/*********************************************************************
+ * Filename :    boot_timeline.cpp
+ *
+ * Description:  Boot timeline. Lines transmitted on the UART are matched
+ *               against milestone regular expressions (built-in Linux
+ *               boot milestones, or +timeline_marks=<file>), and the
+ *               first entry to S-mode and U-mode and the first enabling
+ *               of translation in satp are taken from pcore_tb.sv. The
+ *               events are printed at exit with the cycles between them
+ *               split by privilege mode. +timeline=<file> also writes
+ *               them as CSV
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define TIMELINE_TEXT_SIZE 60
+
+struct timeline_mark {
+  std::string name;
+  std::regex  pattern;
+};
+
+struct timeline_event {
+  uint64_t    cycle;
+  uint64_t    priv_cycles[4];
+  std::string name;
+  std::string text;
+};
+
+// Default milestones of an OpenSBI and Linux boot
+static const char *timeline_default_marks[][2] = {
+  { "opensbi",       "OpenSBI v[0-9]" },
+  { "sbi_next",      "Domain0 Next Address" },
+  { "linux",         "Linux version" },
+  { "console",       "printk: console \\[.*\\] enabled" },
+  { "initcall",      "calling +[a-zA-Z0-9_]+\\+" },
+  { "free_initmem",  "Freeing unused kernel" },
+  { "rootfs",        "VFS: Mounted root|Freeing initrd memory|Run /init" },
+  { "init",          "Run .* as init process|Starting init" },
+  { "userspace",     "Welcome to|login:|~ #" }
+};
+
+static bool                         timeline_on   = false;
+static const char                  *timeline_path = NULL;
+static std::vector<timeline_mark>   timeline_marks;
+static std::vector<timeline_event>  timeline_events;
+
+static std::string                  timeline_line;
+
+static int                          timeline_cur_priv = 3;
+static uint64_t                     timeline_priv_since = 0;
+static uint64_t                     timeline_priv_cycles[4];
+static bool                         timeline_priv_seen[4] = { false, false, false, true };
+static bool                         timeline_satp_seen = false;
+static uint64_t                     timeline_traps = 0;
+static uint64_t                     timeline_satp_writes = 0;
+
+static bool timeline_load_marks(const char *path) {
+  std::ifstream file(path);
+  if (!file)
+    return false;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string name, pattern;
+    if (!(fields >> name) || (name[0] == '#'))
+      continue;
+    std::getline(fields >> std::ws, pattern);
+    timeline_marks.push_back({ name, std::regex(pattern) });
+  }
+  return true;
+}
+
+int timeline_enabled() {
+  const char *arg = Verilated::commandArgsPlusMatch("timeline=");
+  if (!arg[0])
+    return 0;
+  arg += 10;
+  if (!strcmp(arg, "0"))
+    return 0;
+  if (strcmp(arg, "1"))
+    timeline_path = arg;
+
+  const char *arg_marks = Verilated::commandArgsPlusMatch("timeline_marks=");
+  if (arg_marks[0]) {
+    if (!timeline_load_marks(arg_marks + 16)) {
+      printf("Cannot read timeline milestones %s\n", arg_marks + 16);
+      exit(EXIT_FAILURE);
+    }
+  } else {
+    for (auto &mark : timeline_default_marks)
+      timeline_marks.push_back({ mark[0], std::regex(mark[1]) });
+  }
+  timeline_on = true;
+  return 1;
+}
+
+// Cycles spent in each privilege mode up to the given cycle
+static void timeline_priv_snapshot(uint64_t cycle, uint64_t *priv_cycles) {
+  memcpy(priv_cycles, timeline_priv_cycles, sizeof(timeline_priv_cycles));
+  priv_cycles[timeline_cur_priv] += cycle - timeline_priv_since;
+}
+
+static void timeline_add(uint64_t cycle, const std::string &name, const std::string &text) {
+  timeline_event event;
+  event.cycle = cycle;
+  event.name  = name;
+  event.text  = text.substr(0, TIMELINE_TEXT_SIZE);
+  timeline_priv_snapshot(cycle, event.priv_cycles);
+  timeline_events.push_back(event);
+}
+
+void timeline_priv(long long cycle, int priv) {
+  static const char *names[4] = { "first U-mode entry", "first S-mode entry", "", "" };
+
+  timeline_priv_snapshot(cycle, timeline_priv_cycles);
+  timeline_priv_since = cycle;
+  timeline_cur_priv   = priv & 3;
+  timeline_traps     += (priv == 3);
+
+  if (!timeline_priv_seen[priv & 3]) {
+    timeline_priv_seen[priv & 3] = true;
+    timeline_add(cycle, priv ? "priv_s" : "priv_u", names[priv & 3]);
+  }
+}
+
+void timeline_satp(long long cycle, int satp) {
+  timeline_satp_writes++;
+  if (!timeline_satp_seen && (satp < 0)) {
+    char text[32];
+    snprintf(text, sizeof(text), "satp enabled (0x%08x)", (uint32_t)satp);
+    timeline_satp_seen = true;
+    timeline_add(cycle, "satp", text);
+  }
+}
+
+// Called by bench/uart_log.cpp for every transmitted byte, a line is
+// timestamped with the cycle its end of line was transmitted, so the
+// events stay in cycle order with the privilege and satp events that
+// happen while the line is printed
+void timeline_uart(char data) {
+  if (!timeline_on)
+    return;
+
+  if ((data == '\n') || (data == '\r')) {
+    if (!timeline_line.empty()) {
+      for (auto &mark : timeline_marks)
+        if (std::regex_search(timeline_line, mark.pattern))
+          timeline_add(main_time / 10, mark.name, timeline_line);
+    }
+    timeline_line.clear();
+    return;
+  }
+
+  timeline_line.push_back(data);
+}
+
+static void timeline_write(const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    printf("Cannot create timeline %s\n", path);
+    return;
+  }
+
+  fprintf(fp, "cycle,delta,m_cycles,s_cycles,u_cycles,event,text\n");
+  uint64_t prev_cycle = 0, prev[4] = { 0, 0, 0, 0 };
+  for (auto &event : timeline_events) {
+    const uint64_t *c = event.priv_cycles;
+    std::string text = event.text;
+    for (auto &ch : text)
+      if ((ch == '"') || (ch == ','))
+        ch = ' ';
+    fprintf(fp, "%lu,%lu,%lu,%lu,%lu,%s,%s\n", (unsigned long)event.cycle,
+            (unsigned long)(event.cycle - prev_cycle), (unsigned long)(c[3] - prev[3]),
+            (unsigned long)(c[1] - prev[1]), (unsigned long)(c[0] - prev[0]),
+            event.name.c_str(), text.c_str());
+    prev_cycle = event.cycle;
+    memcpy(prev, c, sizeof(prev));
+  }
+  fclose(fp);
+}
+
+void timeline_close() {
+  if (!timeline_on)
+    return;
+  timeline_on = false;
+
+  timeline_add(main_time / 10, "end", "end of simulation");
+
+  printf("Boot timeline (%lu cycles, %lu traps to M-mode, %lu satp writes)\n",
+         (unsigned long)(main_time / 10), (unsigned long)timeline_traps,
+         (unsigned long)timeline_satp_writes);
+  printf("  %14s %14s %6s %6s %6s  %-14s %s\n", "cycle", "delta", "M%", "S%", "U%", "event", "text");
+
+  uint64_t prev_cycle = 0, prev[4] = { 0, 0, 0, 0 };
+  for (auto &event : timeline_events) {
+    const uint64_t *c = event.priv_cycles;
+    uint64_t delta = event.cycle - prev_cycle;
+    double   scale = delta ? 100.0 / delta : 0.0;
+    printf("  %14lu %14lu %5.1f%% %5.1f%% %5.1f%%  %-14s %s\n", (unsigned long)event.cycle,
+           (unsigned long)delta, scale * (c[3] - prev[3]), scale * (c[1] - prev[1]),
+           scale * (c[0] - prev[0]), event.name.c_str(), event.text.c_str());
+    prev_cycle = event.cycle;
+    memcpy(prev, c, sizeof(prev));
+  }
+
+  if (timeline_path) {
+    timeline_write(timeline_path);
+    printf("Boot timeline written to %s\n", timeline_path);
+  }
+}
@@ -0,0 +1,210 @@
+/*********************************************************************
+ * Filename :    commit_log.cpp
+ *
+ * Description:  Binary commit log of the retired instructions. The
+ *               retirement, register writeback and trap events come
+ *               from pcore_tb.sv through DPI, the register write of
+ *               an instruction reaches writeback after it retires so
+ *               records wait in a small in-order queue until their
+ *               rd value arrives. Records are written through a large
+ *               buffer, models built with zstd=1 compress the log
+ *               when the file name ends in .zst. The completed records
+ *               are also checked against the reference model when
+ *               co-simulation is enabled (bench/cosim.cpp)
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcore_tb.h"
+#include "commit_log.h"
+#include "Vpcore_tb__Dpi.h"
+
+#ifdef PCORE_ZSTD
+#include <zstd.h>
+#endif
+
+#define COMMIT_QUEUE_SIZE   64              // Power of two
+#define COMMIT_BUF_SIZE     (1 << 20)
+
+static bool        commit_cosim = false;
+static FILE       *commit_fp = NULL;
+static char       *commit_buf;
+static size_t      commit_buf_len = 0;
+static uint64_t    commit_count = 0;
+
+#ifdef PCORE_ZSTD
+static ZSTD_CCtx  *commit_zstd = NULL;
+static char       *commit_zbuf;
+static size_t      commit_zbuf_size;
+#endif
+
+// Records waiting for their register write, in retirement order
+static commit_rec  commit_queue[COMMIT_QUEUE_SIZE];
+static bool        commit_wait[COMMIT_QUEUE_SIZE];
+static uint32_t    commit_head = 0;
+static uint32_t    commit_tail = 0;
+
+static void commit_flush(bool last) {
+#ifdef PCORE_ZSTD
+  if (commit_zstd) {
+    ZSTD_inBuffer in = { commit_buf, commit_buf_len, 0 };
+    size_t remaining;
+    do {
+      ZSTD_outBuffer out = { commit_zbuf, commit_zbuf_size, 0 };
+      remaining = ZSTD_compressStream2(commit_zstd, &out, &in,
+                                       last ? ZSTD_e_end : ZSTD_e_continue);
+      fwrite(commit_zbuf, 1, out.pos, commit_fp);
+    } while (last ? remaining != 0 : in.pos != in.size);
+    commit_buf_len = 0;
+    return;
+  }
+#endif
+  fwrite(commit_buf, 1, commit_buf_len, commit_fp);
+  commit_buf_len = 0;
+}
+
+static void commit_write(const commit_rec &rec) {
+  commit_count++;
+  if (commit_cosim)
+    cosim_check(rec);
+  if (!commit_fp)
+    return;
+  if (commit_buf_len + sizeof(rec) > COMMIT_BUF_SIZE)
+    commit_flush(false);
+  memcpy(commit_buf + commit_buf_len, &rec, sizeof(rec));
+  commit_buf_len += sizeof(rec);
+}
+
+// Write out the records at the head of the queue that are complete
+static void commit_drain() {
+  while (commit_head != commit_tail && !commit_wait[commit_head % COMMIT_QUEUE_SIZE]) {
+    commit_write(commit_queue[commit_head % COMMIT_QUEUE_SIZE]);
+    commit_head++;
+  }
+}
+
+int commit_log_enabled() {
+  if (commit_fp || commit_cosim)
+    return 1;
+
+  commit_cosim = cosim_open();
+
+  const char *arg = Verilated::commandArgsPlusMatch("trace=");
+  if (!arg[0])
+    return commit_cosim;
+  const char *path = arg + 7;
+
+  size_t len = strlen(path);
+  bool compress = len > 4 && !strcmp(path + len - 4, ".zst");
+#ifndef PCORE_ZSTD
+  if (compress) {
+    printf("Compressed commit logs need a model built with zstd=1\n");
+    exit(EXIT_FAILURE);
+  }
+#endif
+
+  commit_fp = fopen(path, "wb");
+  if (!commit_fp) {
+    printf("Cannot create commit log %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  commit_buf = (char *)malloc(COMMIT_BUF_SIZE);
+
+#ifdef PCORE_ZSTD
+  if (compress) {
+    commit_zstd = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(commit_zstd, ZSTD_c_compressionLevel, 3);
+    commit_zbuf_size = ZSTD_CStreamOutSize();
+    commit_zbuf = (char *)malloc(commit_zbuf_size);
+  }
+#endif
+
+  commit_log_header hdr = { COMMIT_LOG_MAGIC, COMMIT_LOG_VERSION, sizeof(commit_rec), 32, 0 };
+  memcpy(commit_buf, &hdr, sizeof(hdr));
+  commit_buf_len = sizeof(hdr);
+  return 1;
+}
+
+void commit_retire(long long cycle, int pc, int instr, int rd_addr,
+                   int mem_addr, int mem_data, int flags) {
+  // A full queue means a register write never arrived, drop it
+  if (commit_tail - commit_head == COMMIT_QUEUE_SIZE) {
+    commit_wait[commit_head % COMMIT_QUEUE_SIZE] = false;
+    commit_drain();
+  }
+
+  commit_rec &rec = commit_queue[commit_tail % COMMIT_QUEUE_SIZE];
+  rec.cycle    = cycle;
+  rec.pc       = pc;
+  rec.instr    = instr;
+  rec.rd_data  = 0;
+  rec.mem_addr = mem_addr;
+  rec.mem_data = mem_data;
+  rec.rd_addr  = rd_addr;
+  rec.flags    = flags & ~COMMIT_RD;
+  rec.cause    = 0;
+  rec.priv     = flags >> 8;
+  commit_wait[commit_tail % COMMIT_QUEUE_SIZE] = rd_addr != 0;
+  commit_tail++;
+  commit_drain();
+}
+
+// The oldest record waiting for the written register takes the value,
+// records waiting for other registers keep waiting
+void commit_wrb(int rd_addr, int rd_data) {
+  for (uint32_t i = commit_head; i != commit_tail; i++) {
+    uint32_t idx = i % COMMIT_QUEUE_SIZE;
+    commit_rec &rec = commit_queue[idx];
+    if (!commit_wait[idx] || (rec.rd_addr != rd_addr))
+      continue;
+    rec.rd_data = rd_data;
+    rec.flags  |= COMMIT_RD;
+    if (rec.flags & COMMIT_LOAD)
+      rec.mem_data = rd_data;
+    commit_wait[idx] = false;
+    break;
+  }
+  commit_drain();
+}
+
+// A trap kills the instructions still waiting in the load/store unit
+void commit_trap(long long cycle, int pc, int instr, int cause, int priv) {
+  for (uint32_t i = commit_head; i != commit_tail; i++)
+    commit_wait[i % COMMIT_QUEUE_SIZE] = false;
+  commit_drain();
+
+  commit_rec rec = {};
+  rec.cycle = cycle;
+  rec.pc    = pc;
+  rec.instr = instr;
+  rec.cause = cause & 0x1f;
+  rec.flags = COMMIT_TRAP | ((cause < 0) ? COMMIT_IRQ : 0);
+  rec.priv  = priv;
+  commit_write(rec);
+}
+
+void commit_log_close() {
+  if (!commit_fp && !commit_cosim)
+    return;
+
+  for (uint32_t i = commit_head; i != commit_tail; i++)
+    commit_wait[i % COMMIT_QUEUE_SIZE] = false;
+  commit_drain();
+  if (commit_cosim)
+    cosim_close();
+  commit_cosim = false;
+  if (!commit_fp)
+    return;
+
+  commit_flush(true);
+  fclose(commit_fp);
+  commit_fp = NULL;
+#ifdef PCORE_ZSTD
+  if (commit_zstd)
+    ZSTD_freeCCtx(commit_zstd);
+  commit_zstd = NULL;
+#endif
+  printf("Commit log: %lu records\n", (unsigned long)commit_count);
+}
@@ -0,0 +1,85 @@
+/*********************************************************************
+ * Filename :    commit_log.h
+ *
+ * Description:  Record format of the binary commit log, shared by the
+ *               testbench and bench/tools/trace_decode.cpp. The file
+ *               starts with a commit_log_header followed by one
+ *               commit_rec per retired instruction or trap
+ *********************************************************************/
+
+#ifndef COMMIT_LOG_H
+#define COMMIT_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define COMMIT_LOG_MAGIC    0x43525450u     // "PTRC"
+#define COMMIT_LOG_VERSION  1
+
+// Record flags
+#define COMMIT_RD           0x01            // rd_addr/rd_data hold a register write
+#define COMMIT_LOAD         0x02            // mem_addr holds a load address, mem_data the loaded value
+#define COMMIT_STORE        0x04            // mem_addr/mem_data hold a store
+#define COMMIT_TRAP         0x08            // Trap record, pc is the epc and cause holds the code
+#define COMMIT_IRQ          0x10            // Trap caused by an interrupt
+#define COMMIT_SIZE_SHIFT   5               // log2 of the memory access size in bytes
+#define COMMIT_SIZE_MASK    0x60
+
+struct commit_log_header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t rec_size;
+  uint32_t xlen;
+  uint32_t reserved;
+};
+
+struct commit_rec {
+  uint64_t cycle;
+  uint32_t pc;
+  uint32_t instr;
+  uint32_t rd_data;
+  uint32_t mem_addr;
+  uint32_t mem_data;
+  uint8_t  rd_addr;
+  uint8_t  flags;
+  uint8_t  cause;
+  uint8_t  priv;
+};
+
+static_assert(sizeof(commit_rec) == 32, "commit_rec layout");
+
+static const char *const commit_exc_names[16] = {
+  "trap_instruction_address_misaligned", "trap_instruction_access_fault",
+  "trap_illegal_instruction",            "trap_breakpoint",
+  "trap_load_address_misaligned",        "trap_load_access_fault",
+  "trap_store_address_misaligned",       "trap_store_access_fault",
+  "trap_user_ecall",                     "trap_supervisor_ecall",
+  "trap_virtual_supervisor_ecall",       "trap_machine_ecall",
+  "trap_instruction_page_fault",         "trap_load_page_fault",
+  "trap_reserved",                       "trap_store_page_fault"
+};
+
+// Prints a record as a line of the Spike commit log (--log-commits)
+static inline void commit_rec_print(FILE *fp, const commit_rec &rec) {
+  if (rec.flags & COMMIT_TRAP) {
+    if (rec.flags & COMMIT_IRQ)
+      fprintf(fp, "core   0: exception interrupt #%u, epc 0x%08x\n", rec.cause, rec.pc);
+    else
+      fprintf(fp, "core   0: exception %s, epc 0x%08x\n", commit_exc_names[rec.cause & 0xf], rec.pc);
+    return;
+  }
+
+  fprintf(fp, "core   0: %u 0x%08x (0x%08x)", rec.priv, rec.pc, rec.instr);
+  if (rec.flags & COMMIT_RD)
+    fprintf(fp, " x%-2u 0x%08x", rec.rd_addr, rec.rd_data);
+  if (rec.flags & COMMIT_LOAD)
+    fprintf(fp, " mem 0x%08x", rec.mem_addr);
+  if (rec.flags & COMMIT_STORE) {
+    int digits = 2 << ((rec.flags & COMMIT_SIZE_MASK) >> COMMIT_SIZE_SHIFT);
+    uint32_t mask = digits == 8 ? 0xffffffffu : (1u << (digits * 4)) - 1;
+    fprintf(fp, " mem 0x%08x 0x%0*x", rec.mem_addr, digits, rec.mem_data & mask);
+  }
+  fprintf(fp, "\n");
+}
+
+#endif
@@ -0,0 +1,265 @@
+/*********************************************************************
+ * Filename :    cosim.cpp
+ *
+ * Description:  Lockstep co-simulation against the Spike ISS. Every
+ *               record of the commit log steps the reference hart by
+ *               one instruction or trap, and the simulation stops at
+ *               the first difference in PC, register write, store or
+ *               trap cause. Spike keeps its own copy of main memory,
+ *               filled from the simulated memory on first access.
+ *               Fetches and loads outside main memory (boot memory,
+ *               peripherals) return the values seen by the core, and
+ *               interrupts are injected when the core takes them
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcore_tb.h"
+#include "commit_log.h"
+#include "Vpcore_tb__Dpi.h"
+
+#ifdef PCORE_SPIKE
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include "riscv/cfg.h"
+#include "riscv/processor.h"
+#include "riscv/simif.h"
+
+#define COSIM_ISA        "rv32ima_zicsr_zifencei_zba_zbb_zbc_zbs"
+#define COSIM_MEM_BASE   0x80000000u
+#define COSIM_MEM_SIZE   (1u << 26)        // MEM_ADDR_WIDTH in pcore_config_defs.svh
+#define COSIM_HIST_SIZE  8                 // Records printed before a mismatch, power of two
+
+#define INSTR_ECALL      0x00000073u
+#define INSTR_EBREAK     0x00100073u
+
+// Record of the core being checked, it supplies the data of the
+// accesses outside main memory
+static const commit_rec *cosim_rec = NULL;
+
+class cosim_sim_t : public simif_t {
+public:
+  cosim_sim_t(const cfg_t *cfg) : cfg(cfg) {}
+
+  char *addr_to_mem(reg_t paddr) override {
+    if (paddr < COSIM_MEM_BASE || paddr - COSIM_MEM_BASE >= COSIM_MEM_SIZE)
+      return NULL;
+    reg_t  page = paddr >> 12;
+    char *&mem  = pages[page];
+    if (!mem) {
+      mem = new char[4096];
+      for (int i = 0; i < 1024; i++) {
+        int word = mem_read_word((page << 12) + i * 4);
+        memcpy(mem + i * 4, &word, 4);
+      }
+    }
+    return mem + (paddr & 0xfff);
+  }
+
+  bool mmio_fetch(reg_t paddr, size_t len, uint8_t *bytes) override {
+    if (!cosim_rec || paddr < cosim_rec->pc || paddr + len > cosim_rec->pc + 4)
+      return false;
+    uint32_t instr = cosim_rec->instr >> ((paddr - cosim_rec->pc) * 8);
+    memcpy(bytes, &instr, len);
+    return true;
+  }
+
+  bool mmio_load(reg_t paddr, size_t len, uint8_t *bytes) override {
+    uint32_t data = cosim_rec ? cosim_rec->mem_data : 0;
+    memset(bytes, 0, len);
+    memcpy(bytes, &data, len < 4 ? len : 4);
+    return true;
+  }
+
+  bool mmio_store(reg_t paddr, size_t len, const uint8_t *bytes) override {
+    return true;
+  }
+
+  void proc_reset(unsigned id) override {}
+  const cfg_t &get_cfg() const override { return *cfg; }
+  const std::map<size_t, processor_t *> &get_harts() const override { return harts; }
+  const char *get_symbol(uint64_t paddr) override { return NULL; }
+
+  std::map<size_t, processor_t *> harts;
+
+private:
+  const cfg_t                              *cfg;
+  std::unordered_map<reg_t, char *>         pages;
+};
+
+static cfg_t        *cosim_cfg;
+static cosim_sim_t  *cosim_sim;
+static processor_t  *cosim_proc;
+static FILE         *cosim_log;
+
+static bool          cosim_started = false;
+static bool          cosim_failed  = false;
+static uint64_t      cosim_count   = 0;
+static commit_rec    cosim_hist[COSIM_HIST_SIZE];
+
+// Counters and pending interrupts differ between the core and the
+// reference, their reads take the value read by the core
+static bool cosim_csr_sync(uint32_t instr) {
+  if ((instr & 0x7f) != 0x73 || !(instr & 0x3000))
+    return false;
+  uint32_t csr = instr >> 20;
+  return (csr >= 0xb00 && csr <= 0xb1f) || (csr >= 0xb80 && csr <= 0xb9f) ||
+         (csr >= 0xc00 && csr <= 0xc1f) || (csr >= 0xc80 && csr <= 0xc9f) ||
+         (csr >= 0x323 && csr <= 0x33f) || csr == 0x344 || csr == 0x144;
+}
+
+static void cosim_fail(const char *what, const commit_rec &dut, const commit_rec &ref) {
+  cosim_failed = true;
+  printf("Cosim mismatch (%s) at cycle %lu after %lu instructions\n", what,
+         (unsigned long)dut.cycle, (unsigned long)cosim_count);
+  printf("  DUT: ");
+  commit_rec_print(stdout, dut);
+  printf("  REF: ");
+  commit_rec_print(stdout, ref);
+  printf("Last checked records:\n");
+  uint64_t first = cosim_count > COSIM_HIST_SIZE ? cosim_count - COSIM_HIST_SIZE : 0;
+  for (uint64_t i = first; i < cosim_count; i++) {
+    printf("  %10lu ", (unsigned long)cosim_hist[i % COSIM_HIST_SIZE].cycle);
+    commit_rec_print(stdout, cosim_hist[i % COSIM_HIST_SIZE]);
+  }
+  sim_exit(1, "cosim mismatch");
+  Verilated::gotFinish(true);
+}
+
+bool cosim_open() {
+  const char *arg = Verilated::commandArgsPlusMatch("cosim=");
+  if (!arg[0] || !atoi(arg + 7))
+    return false;
+
+  // Spike writes its own commit log with +cosim_log=<file>
+  const char *arg_log = Verilated::commandArgsPlusMatch("cosim_log=");
+  cosim_log = fopen(arg_log[0] ? arg_log + 11 : "/dev/null", "w");
+
+  cosim_cfg = new cfg_t();
+  cosim_cfg->isa        = COSIM_ISA;
+  cosim_cfg->priv       = "MSU";
+  cosim_cfg->pmpregions = 0;
+  cosim_cfg->hartids    = std::vector<size_t>(1, 0);
+
+  cosim_sim  = new cosim_sim_t(cosim_cfg);
+  cosim_proc = new processor_t(COSIM_ISA, "MSU", cosim_cfg, cosim_sim, 0, false,
+                               cosim_log, std::cout);
+  cosim_sim->harts[0] = cosim_proc;
+  cosim_proc->enable_log_commits();
+  printf("Co-simulation with Spike (%s)\n", COSIM_ISA);
+  return true;
+}
+
+void cosim_check(const commit_rec &rec) {
+  if (cosim_failed)
+    return;
+
+  state_t *state = cosim_proc->get_state();
+
+  // The reference starts at the first PC retired by the core
+  if (!cosim_started) {
+    state->pc = (reg_t)(int64_t)(int32_t)rec.pc;
+    cosim_started = true;
+  }
+
+  // ecall and ebreak retire in the core and trap in Spike, the trap
+  // record that follows steps the reference
+  if (!(rec.flags & COMMIT_TRAP) && (rec.instr == INSTR_ECALL || rec.instr == INSTR_EBREAK)) {
+    cosim_hist[cosim_count++ % COSIM_HIST_SIZE] = rec;
+    return;
+  }
+
+  commit_rec ref = {};
+  ref.cycle = rec.cycle;
+  ref.pc    = (uint32_t)state->pc;
+  ref.instr = rec.instr;
+  ref.priv  = state->prv;
+  if (ref.pc != rec.pc) {
+    ref.flags = rec.flags & COMMIT_TRAP;
+    cosim_fail("pc", rec, ref);
+    return;
+  }
+
+  reg_t irq_mask = (rec.flags & COMMIT_IRQ) ? (reg_t)1 << rec.cause : 0;
+  if (irq_mask)
+    state->mip->backdoor_write_with_mask(irq_mask, irq_mask);
+  state->log_reg_write.clear();
+  state->log_mem_read.clear();
+  state->log_mem_write.clear();
+
+  cosim_rec = &rec;
+  cosim_proc->step(1);
+  cosim_rec = NULL;
+
+  if (irq_mask)
+    state->mip->backdoor_write_with_mask(irq_mask, 0);
+
+  if (rec.flags & COMMIT_TRAP) {
+    reg_t cause = cosim_proc->get_csr(state->prv == PRV_M ? CSR_MCAUSE : CSR_SCAUSE);
+    ref.cause = cause & 0x1f;
+    ref.flags = COMMIT_TRAP | ((cause >> 31) & 1 ? COMMIT_IRQ : 0);
+    if (ref.cause != rec.cause || ref.flags != (rec.flags & (COMMIT_TRAP | COMMIT_IRQ)) ||
+        !state->log_mem_write.empty()) {
+      cosim_fail("trap", rec, ref);
+      return;
+    }
+  } else {
+    for (auto &reg : state->log_reg_write) {
+      if ((reg.first & 0xf) || !(reg.first >> 4))
+        continue;
+      ref.rd_addr = reg.first >> 4;
+      ref.rd_data = (uint32_t)reg.second.v[0];
+      ref.flags  |= COMMIT_RD;
+    }
+    for (auto &mem : state->log_mem_write) {
+      ref.mem_addr = (uint32_t)std::get<0>(mem);
+      ref.mem_data = (uint32_t)std::get<1>(mem);
+      ref.flags   |= COMMIT_STORE | (rec.flags & COMMIT_SIZE_MASK);
+    }
+    if ((rec.flags & COMMIT_RD) && (ref.flags & COMMIT_RD) && cosim_csr_sync(rec.instr)) {
+      state->XPR.write(rec.rd_addr, (reg_t)(int64_t)(int32_t)rec.rd_data);
+      ref.rd_data = rec.rd_data;
+    }
+    if ((rec.flags & COMMIT_RD) != (ref.flags & COMMIT_RD) ||
+        ((rec.flags & COMMIT_RD) && (ref.rd_addr != rec.rd_addr || ref.rd_data != rec.rd_data))) {
+      cosim_fail("register write", rec, ref);
+      return;
+    }
+    uint32_t size_mask = 0xffffffffu >> (32 - (8 << ((rec.flags & COMMIT_SIZE_MASK) >> COMMIT_SIZE_SHIFT)));
+    if ((rec.flags & COMMIT_STORE) &&
+        (!(ref.flags & COMMIT_STORE) || ref.mem_addr != rec.mem_addr ||
+         ((ref.mem_data ^ rec.mem_data) & size_mask))) {
+      cosim_fail("store", rec, ref);
+      return;
+    }
+  }
+
+  cosim_hist[cosim_count++ % COSIM_HIST_SIZE] = rec;
+}
+
+void cosim_close() {
+  if (!cosim_failed)
+    printf("Co-simulation: %lu records matched\n", (unsigned long)cosim_count);
+  if (cosim_log)
+    fclose(cosim_log);
+}
+
+#else
+
+bool cosim_open() {
+  const char *arg = Verilated::commandArgsPlusMatch("cosim=");
+  if (arg[0] && atoi(arg + 7)) {
+    printf("Co-simulation needs a model built with cosim=1\n");
+    exit(EXIT_FAILURE);
+  }
+  return false;
+}
+
+void cosim_check(const commit_rec &rec) {}
+
+void cosim_close() {}
+
+#endif
@@ -0,0 +1,160 @@
+/*********************************************************************
+ * Filename :    cpi_stack.cpp
+ *
+ * Description:  CPI stack. pcore_tb.sv assigns every cycle to one
+ *               category and passes runs of cycles with the PC they
+ *               are accounted to. The breakdown of all cycles and of
+ *               the regions with the most stall cycles is printed at
+ *               exit. With +cpi=<file> the counts of every PC region
+ *               (+cpi_region=<bytes>, default 4) are written as text,
+ *               bench/tools/cpi_report.py groups them by function
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define CPI_TOP_REGIONS 10
+
+// Order of type_cpi_e in pcore_tb.sv
+enum {
+  CPI_RETIRE,
+  CPI_FETCH,
+  CPI_BRANCH,
+  CPI_LOAD_USE,
+  CPI_LSU,
+  CPI_MEXT,
+  CPI_TRAP,
+  CPI_WFI,
+  CPI_CATEGORIES
+};
+
+static const char *cpi_names[CPI_CATEGORIES] = {
+  "retire", "fetch", "branch", "load_use", "lsu", "mext", "trap", "wfi"
+};
+
+static const char *cpi_titles[CPI_CATEGORIES] = {
+  "retiring", "fetch stall", "branch/jump flush", "load-use",
+  "LSU/dcache wait", "M-extension wait", "trap/CSR flush", "wfi"
+};
+
+struct cpi_counts {
+  uint64_t cycles[CPI_CATEGORIES];
+};
+
+static bool                                   cpi_on = false;
+static const char                            *cpi_path = NULL;
+static uint32_t                               cpi_region_mask = ~3u;
+static cpi_counts                             cpi_total;
+static std::unordered_map<uint32_t, cpi_counts> cpi_regions;
+
+int cpi_enabled() {
+  const char *arg = Verilated::commandArgsPlusMatch("cpi=");
+  if (!arg[0])
+    return 0;
+  arg += 5;
+  if (!strcmp(arg, "0"))
+    return 0;
+  if (strcmp(arg, "1"))
+    cpi_path = arg;
+
+  // Regions are aligned powers of two
+  const char *arg_region = Verilated::commandArgsPlusMatch("cpi_region=");
+  if (arg_region[0]) {
+    uint32_t size = strtoul(arg_region + 12, NULL, 0);
+    if (size < 4 || (size & (size - 1))) {
+      printf("+cpi_region must be a power of two of at least 4\n");
+      exit(EXIT_FAILURE);
+    }
+    cpi_region_mask = ~(size - 1);
+  }
+  cpi_on = true;
+  return 1;
+}
+
+void cpi_account(int pc, int category, long long cycles) {
+  cpi_total.cycles[category] += cycles;
+  cpi_regions[(uint32_t)pc & cpi_region_mask].cycles[category] += cycles;
+}
+
+static uint64_t cpi_sum(const cpi_counts &counts) {
+  uint64_t sum = 0;
+  for (int i = 0; i < CPI_CATEGORIES; i++)
+    sum += counts.cycles[i];
+  return sum;
+}
+
+static void cpi_write(const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    printf("Cannot create CPI stack %s\n", path);
+    return;
+  }
+
+  std::vector<uint32_t> regions;
+  for (auto &region : cpi_regions)
+    regions.push_back(region.first);
+  std::sort(regions.begin(), regions.end());
+
+  fprintf(fp, "# region");
+  for (int i = 0; i < CPI_CATEGORIES; i++)
+    fprintf(fp, " %s", cpi_names[i]);
+  fprintf(fp, "\n");
+  for (uint32_t region : regions) {
+    fprintf(fp, "%08x", region);
+    for (int i = 0; i < CPI_CATEGORIES; i++)
+      fprintf(fp, " %lu", (unsigned long)cpi_regions[region].cycles[i]);
+    fprintf(fp, "\n");
+  }
+  fclose(fp);
+}
+
+void cpi_close() {
+  if (!cpi_on)
+    return;
+  cpi_on = false;
+
+  uint64_t cycles = cpi_sum(cpi_total);
+  uint64_t instrs = cpi_total.cycles[CPI_RETIRE];
+  printf("CPI stack (%lu cycles, %lu instructions, CPI %.3f)\n", (unsigned long)cycles,
+         (unsigned long)instrs, instrs ? (double)cycles / instrs : 0.0);
+  for (int i = 0; i < CPI_CATEGORIES; i++)
+    printf("  %-18s %14lu  %6.2f%%  %.3f\n", cpi_titles[i], (unsigned long)cpi_total.cycles[i],
+           cycles ? 100.0 * cpi_total.cycles[i] / cycles : 0.0,
+           instrs ? (double)cpi_total.cycles[i] / instrs : 0.0);
+
+  // Regions that lose the most cycles, wfi is not counted as a loss
+  std::vector<std::pair<uint64_t, uint32_t>> stalls;
+  for (auto &region : cpi_regions) {
+    const cpi_counts &counts = region.second;
+    uint64_t lost = cpi_sum(counts) - counts.cycles[CPI_RETIRE] - counts.cycles[CPI_WFI];
+    if (lost)
+      stalls.push_back(std::make_pair(lost, region.first));
+  }
+  std::sort(stalls.rbegin(), stalls.rend());
+  if (stalls.size() > CPI_TOP_REGIONS)
+    stalls.resize(CPI_TOP_REGIONS);
+
+  if (!stalls.empty())
+    printf("  %-10s %12s %10s  %s\n", "region", "stalls", "retired", "largest cause");
+  for (auto &stall : stalls) {
+    const cpi_counts &counts = cpi_regions[stall.second];
+    int cause = CPI_FETCH;
+    for (int i = CPI_FETCH; i < CPI_WFI; i++)
+      if (counts.cycles[i] > counts.cycles[cause])
+        cause = i;
+    printf("  0x%08x %12lu %10lu  %s\n", stall.second, (unsigned long)stall.first,
+           (unsigned long)counts.cycles[CPI_RETIRE], cpi_titles[cause]);
+  }
+
+  if (cpi_path) {
+    cpi_write(cpi_path);
+    printf("CPI stack written to %s\n", cpi_path);
+  }
+}
@@ -0,0 +1,134 @@
+/*********************************************************************
+ * Filename :    mem_image.cpp
+ *
+ * Description:  Loads ELF segments or raw binary images straight into
+ *               the simulated main memory and boot memory, without the
+ *               hex text conversion needed by $readmemh
+ *********************************************************************/
+
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define DMEM_BASE   0x80000000u
+#define DMEM_SIZE   0x04000000u
+#define BMEM_BASE   0x00001000u
+#define BMEM_SIZE   0x00001000u
+
+static bool mem_image_range(uint32_t addr, uint32_t size) {
+  return ((addr >= DMEM_BASE) && (size <= DMEM_SIZE) && (addr - DMEM_BASE <= DMEM_SIZE - size)) ||
+         ((addr >= BMEM_BASE) && (size <= BMEM_SIZE) && (addr - BMEM_BASE <= BMEM_SIZE - size));
+}
+
+// Copy a block of the image to memory a word at a time, the last
+// partial word is padded with zeros
+static bool mem_image_copy(const uint8_t *data, uint32_t addr, uint32_t size) {
+  if ((addr & 0x3) || !mem_image_range(addr, size)) {
+    printf("Error: image block 0x%08x-0x%08x is outside memory\n", addr, addr + size);
+    return false;
+  }
+
+  for (uint32_t offset = 0; offset < size; offset += 4) {
+    uint32_t word = 0;
+    memcpy(&word, data + offset, (size - offset < 4) ? size - offset : 4);
+    mem_write_word(addr + offset, word);
+  }
+  return true;
+}
+
+static bool mem_image_elf(const uint8_t *data, size_t size) {
+  const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)data;
+
+  if ((size < sizeof(Elf32_Ehdr)) || (ehdr->e_ident[EI_CLASS] != ELFCLASS32) ||
+      (ehdr->e_phoff + (size_t)ehdr->e_phnum * sizeof(Elf32_Phdr) > size)) {
+    printf("Error: only 32-bit ELF images are supported\n");
+    return false;
+  }
+
+  const Elf32_Phdr *phdr = (const Elf32_Phdr *)(data + ehdr->e_phoff);
+  for (int i = 0; i < ehdr->e_phnum; i++) {
+    if ((phdr[i].p_type != PT_LOAD) || (phdr[i].p_filesz == 0))
+      continue;
+    if (phdr[i].p_offset + (size_t)phdr[i].p_filesz > size) {
+      printf("Error: truncated ELF segment %d\n", i);
+      return false;
+    }
+    // Memory is zero initialized, so only the file part is copied
+    if (!mem_image_copy(data + phdr[i].p_offset, phdr[i].p_paddr, phdr[i].p_filesz))
+      return false;
+  }
+  return true;
+}
+
+// Load an ELF or raw image, raw images are placed at the given address.
+// Returns false when the image cannot be read or does not fit in memory
+bool mem_image_load_file(const char *filename, uint32_t addr) {
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+  if ((fd < 0) || fstat(fd, &st) || (st.st_size == 0)) {
+    printf("Error: cannot read image %s\n", filename);
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    printf("Error: cannot map image %s\n", filename);
+    return false;
+  }
+
+  const uint8_t *data = (const uint8_t *)map;
+  bool ok;
+  if ((st.st_size >= SELFMAG) && !memcmp(data, ELFMAG, SELFMAG))
+    ok = mem_image_elf(data, st.st_size);
+  else
+    ok = mem_image_copy(data, addr, st.st_size);
+
+  munmap(map, st.st_size);
+  return ok;
+}
+
+// DPI function called by pcore_tb.sv for the +image and +bmem plusargs,
+// a single image simulation cannot continue without its image
+void mem_image_load(const char *filename, int addr) {
+  if (!mem_image_load_file(filename, (uint32_t)addr))
+    exit(EXIT_FAILURE);
+}
+
+// $readmemh compatible loader for the batch mode, the hex words are
+// placed from the start of main memory. Zero words are skipped as the
+// memory is cleared before each image
+bool mem_image_load_hex(const char *filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    printf("Error: cannot read image %s\n", filename);
+    return false;
+  }
+
+  std::string token;
+  uint32_t word_addr = 0;
+  while (file >> token) {
+    if (token.compare(0, 2, "//") == 0) {
+      std::getline(file, token);
+    } else if (token[0] == '@') {
+      word_addr = strtoul(token.c_str() + 1, NULL, 16);
+    } else {
+      uint32_t data = strtoul(token.c_str(), NULL, 16);
+      if (data)
+        mem_write_word(DMEM_BASE + word_addr * 4, data);
+      word_addr++;
+    }
+  }
+  return true;
+}
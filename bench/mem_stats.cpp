@@ -0,0 +1,188 @@
+/*********************************************************************
+ * Filename :    mem_stats.cpp
+ *
+ * Description:  Memory hierarchy statistics. pcore_tb.sv passes the
+ *               cache, TLB, page table walker and memory arbiter events
+ *               of each cycle as a bit mask, they are counted here and
+ *               summarised at the end of the simulation. With
+ *               +mem_stats=<file> the totals are also written as JSON,
+ *               +mem_stats_interval=<N> adds the counts of every N
+ *               cycles to the JSON file, or prints them without one
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+// Bit order of the events in pcore_tb.sv
+enum {
+  MS_ICACHE_HIT,
+  MS_ICACHE_MISS,
+  MS_ICACHE_REFILL_CYCLES,
+  MS_DCACHE_HIT,
+  MS_DCACHE_MISS,
+  MS_DCACHE_REFILL_CYCLES,
+  MS_DCACHE_WRITEBACK,
+  MS_DCACHE_FLUSH_CYCLES,
+  MS_ITLB_MISS,
+  MS_DTLB_MISS,
+  MS_PTW_CYCLES,
+  MS_MEM_ICACHE_GRANT,
+  MS_MEM_DCACHE_GRANT,
+  MS_MEM_ICACHE_WAIT,
+  MS_MEM_DCACHE_WAIT,
+  MS_MEM_ICACHE_KILL,
+  MS_MEM_DCACHE_KILL,
+  MS_MEM_TIMEOUT,
+  MS_EVENTS
+};
+
+static const char *mem_stats_names[MS_EVENTS] = {
+  "icache_hits", "icache_misses", "icache_refill_cycles",
+  "dcache_hits", "dcache_misses", "dcache_refill_cycles",
+  "dcache_writebacks", "dcache_flush_cycles",
+  "itlb_misses", "dtlb_misses", "ptw_cycles",
+  "mem_icache_grants", "mem_dcache_grants",
+  "mem_icache_wait_cycles", "mem_dcache_wait_cycles",
+  "mem_icache_kills", "mem_dcache_kills", "mem_timeouts"
+};
+
+struct mem_stats_interval {
+  uint64_t cycle;
+  uint64_t counts[MS_EVENTS];
+};
+
+static bool                              mem_stats_on = false;
+static const char                       *mem_stats_path = NULL;
+static uint64_t                          mem_stats_period = 0;
+static uint64_t                          mem_stats_next = 0;
+static uint64_t                          mem_stats_counts[MS_EVENTS];
+static uint64_t                          mem_stats_last[MS_EVENTS];
+static std::vector<mem_stats_interval>   mem_stats_intervals;
+
+int mem_stats_enabled() {
+  const char *arg = Verilated::commandArgsPlusMatch("mem_stats=");
+  if (!arg[0])
+    return 0;
+  arg += 11;
+  if (!strcmp(arg, "0"))
+    return 0;
+  if (strcmp(arg, "1"))
+    mem_stats_path = arg;
+
+  const char *arg_interval = Verilated::commandArgsPlusMatch("mem_stats_interval=");
+  if (arg_interval[0])
+    mem_stats_period = strtoull(arg_interval + 20, NULL, 0);
+  mem_stats_next = mem_stats_period;
+  mem_stats_on   = true;
+  return 1;
+}
+
+static double ratio(uint64_t num, uint64_t den) {
+  return den ? (double)num / den : 0.0;
+}
+
+static void mem_stats_print_interval(const mem_stats_interval &iv) {
+  const uint64_t *c = iv.counts;
+  printf("[mem_stats] %12lu  icache %lu/%lu  dcache %lu/%lu  wrb %lu  itlb %lu  dtlb %lu"
+         "  ptw %lu  wait %lu/%lu\n", (unsigned long)iv.cycle,
+         (unsigned long)c[MS_ICACHE_HIT], (unsigned long)c[MS_ICACHE_MISS],
+         (unsigned long)c[MS_DCACHE_HIT], (unsigned long)c[MS_DCACHE_MISS],
+         (unsigned long)c[MS_DCACHE_WRITEBACK], (unsigned long)c[MS_ITLB_MISS],
+         (unsigned long)c[MS_DTLB_MISS], (unsigned long)c[MS_PTW_CYCLES],
+         (unsigned long)c[MS_MEM_ICACHE_WAIT], (unsigned long)c[MS_MEM_DCACHE_WAIT]);
+}
+
+// Closes the intervals that ended before the given cycle
+static void mem_stats_advance(uint64_t cycle) {
+  while (mem_stats_period && cycle >= mem_stats_next) {
+    mem_stats_interval iv;
+    iv.cycle = mem_stats_next;
+    for (int i = 0; i < MS_EVENTS; i++) {
+      iv.counts[i]        = mem_stats_counts[i] - mem_stats_last[i];
+      mem_stats_last[i]   = mem_stats_counts[i];
+    }
+    if (mem_stats_path)
+      mem_stats_intervals.push_back(iv);
+    else
+      mem_stats_print_interval(iv);
+    mem_stats_next += mem_stats_period;
+  }
+}
+
+void mem_stats_event(long long cycle, int events) {
+  mem_stats_advance(cycle);
+  for (int i = 0; events; i++, events >>= 1)
+    mem_stats_counts[i] += events & 1;
+}
+
+static void mem_stats_write_json(uint64_t cycles) {
+  FILE *fp = fopen(mem_stats_path, "w");
+  if (!fp) {
+    printf("Cannot create memory statistics %s\n", mem_stats_path);
+    return;
+  }
+
+  fprintf(fp, "{\n  \"cycles\": %lu,\n  \"interval\": %lu,\n  \"totals\": {",
+          (unsigned long)cycles, (unsigned long)mem_stats_period);
+  for (int i = 0; i < MS_EVENTS; i++)
+    fprintf(fp, "%s\n    \"%s\": %lu", i ? "," : "", mem_stats_names[i],
+            (unsigned long)mem_stats_counts[i]);
+  fprintf(fp, "\n  },\n  \"intervals\": [");
+  for (size_t n = 0; n < mem_stats_intervals.size(); n++) {
+    const mem_stats_interval &iv = mem_stats_intervals[n];
+    fprintf(fp, "%s\n    {\"cycle\": %lu", n ? "," : "", (unsigned long)iv.cycle);
+    for (int i = 0; i < MS_EVENTS; i++)
+      fprintf(fp, ", \"%s\": %lu", mem_stats_names[i], (unsigned long)iv.counts[i]);
+    fprintf(fp, "}");
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  fclose(fp);
+}
+
+void mem_stats_close() {
+  if (!mem_stats_on)
+    return;
+  mem_stats_on = false;
+
+  // The last partial interval ends with the simulation
+  uint64_t cycles = main_time / 10;
+  mem_stats_advance(cycles);
+  if (mem_stats_period && cycles > mem_stats_next - mem_stats_period) {
+    mem_stats_next = cycles;
+    mem_stats_advance(cycles);
+  }
+
+  const uint64_t *c = mem_stats_counts;
+  uint64_t walks = c[MS_ITLB_MISS] + c[MS_DTLB_MISS];
+  printf("Memory hierarchy statistics (%lu cycles)\n", (unsigned long)cycles);
+  printf("  icache: %lu hits, %lu misses (%.2f%%), %.1f cycles per refill\n",
+         (unsigned long)c[MS_ICACHE_HIT], (unsigned long)c[MS_ICACHE_MISS],
+         100.0 * ratio(c[MS_ICACHE_MISS], c[MS_ICACHE_HIT] + c[MS_ICACHE_MISS]),
+         ratio(c[MS_ICACHE_REFILL_CYCLES], c[MS_ICACHE_MISS]));
+  printf("  dcache: %lu hits, %lu misses (%.2f%%), %.1f cycles per miss\n",
+         (unsigned long)c[MS_DCACHE_HIT], (unsigned long)c[MS_DCACHE_MISS],
+         100.0 * ratio(c[MS_DCACHE_MISS], c[MS_DCACHE_HIT] + c[MS_DCACHE_MISS]),
+         ratio(c[MS_DCACHE_REFILL_CYCLES], c[MS_DCACHE_MISS]));
+  printf("          %lu writebacks, %lu flush cycles\n",
+         (unsigned long)c[MS_DCACHE_WRITEBACK], (unsigned long)c[MS_DCACHE_FLUSH_CYCLES]);
+  printf("  tlb:    %lu itlb misses, %lu dtlb misses\n",
+         (unsigned long)c[MS_ITLB_MISS], (unsigned long)c[MS_DTLB_MISS]);
+  printf("  ptw:    %lu walks, %lu cycles, %.1f cycles per walk\n", (unsigned long)walks,
+         (unsigned long)c[MS_PTW_CYCLES], ratio(c[MS_PTW_CYCLES], walks));
+  printf("  memory: %lu icache and %lu dcache requests, %lu/%lu cycles waiting for the other cache\n",
+         (unsigned long)c[MS_MEM_ICACHE_GRANT], (unsigned long)c[MS_MEM_DCACHE_GRANT],
+         (unsigned long)c[MS_MEM_ICACHE_WAIT], (unsigned long)c[MS_MEM_DCACHE_WAIT]);
+  printf("          %lu icache kills, %lu dcache kills, %lu timeouts\n",
+         (unsigned long)c[MS_MEM_ICACHE_KILL], (unsigned long)c[MS_MEM_DCACHE_KILL],
+         (unsigned long)c[MS_MEM_TIMEOUT]);
+
+  if (mem_stats_path) {
+    mem_stats_write_json(cycles);
+    printf("Memory statistics written to %s\n", mem_stats_path);
+  }
+}
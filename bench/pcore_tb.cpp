@@ -1,66 +1,361 @@
 #include <stdint.h>
 #include <iostream>
 #include <signal.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include "Vpcore_tb.h"
-#include "verilated_vcd_c.h"
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
 
 
-static bool done = false;
+// Set by the ctrl-c handler and read by every batch thread
+static std::atomic<bool> done(false);
 
-vluint64_t main_time = 0;
+thread_local vluint64_t main_time = 0;
 
 double sc_time_stamp () {
  return main_time;
 }
 
+// Exit status reported through the simulation exit register or on a hang
+static thread_local bool exit_valid = false;
+static thread_local int  exit_code  = 0;
+
+void sim_exit(int code, const char *reason) {
+  exit_valid = true;
+  exit_code  = code;
+  printf("Simulation exit (%s) with code %d at cycle %lu\n", reason, code,
+         (unsigned long)(main_time / 10));
+}
+
+// Idle cycles skipped in wfi fast-forward mode, the simulation time
+// advances as if these cycles were simulated
+static thread_local vluint64_t skipped_cycles = 0;
+
+void sim_skip(long long cycles) {
+  skipped_cycles += cycles;
+  main_time += cycles * 10;
+}
+
 void INThandler(int signal)
 {
   printf("\nCaught ctrl-c\n");
   done = true;
 }
 
+#ifdef PCORE_SAVABLE
+// Save the model together with the testbench state (time and UART log position)
+static void save_checkpoint(Vpcore_tb* tb, const char *filename) {
+  VerilatedSave os;
+  os.open(filename);
+  uint64_t uart_pos = uart_log_pos();
+  os << main_time << uart_pos;
+  os << *tb;
+#ifdef SPARSE_MEM
+  sparse_mem_save(os);
+#endif
+  os.close();
+  printf("Checkpoint saved to %s at cycle %lu\n", filename, (unsigned long)(main_time / 10));
+}
+
+static void restore_checkpoint(Vpcore_tb* tb, const char *filename) {
+  VerilatedRestore os;
+  os.open(filename);
+  uint64_t uart_pos;
+  os >> main_time >> uart_pos;
+  os >> *tb;
+#ifdef SPARSE_MEM
+  sparse_mem_restore(os);
+#endif
+  os.close();
+  uart_log_open("uart_logdata.log", uart_pos);
+  printf("Checkpoint restored from %s at cycle %lu\n", filename, (unsigned long)(main_time / 10));
+}
+#endif
+
+// One clock edge: reset is held for the first 10 cycles
+static void sim_step(Vpcore_tb* tb) {
+  tb->reset = main_time > 100;
+  tb->eval();
+  wave_dump(main_time);
+
+  tb->clk = !tb->clk;
+  main_time+=5;
+}
+
+// ====================== Batch mode ========================== //
+
+// Images listed in the +batch=<file> list run back to back on models that
+// are reset between them instead of a new process per image, +batch_threads
+// runs several models in parallel. Each line of the list holds an image
+// (hex, ELF or raw binary) and optionally the signature file of an
+// architecture test
+struct batch_entry {
+  std::string image;
+  std::string signature;
+  std::string uart_log;
+  std::string result;
+  vluint64_t  cycles;
+  double      secs;
+};
+
+static std::vector<batch_entry> batch_list;
+static std::atomic<size_t>      batch_next(0);
+static std::mutex               batch_mutex;
+static vluint64_t               batch_max_cycles = 0;
+
+static bool batch_hex(const std::string &image) {
+  size_t dot = image.rfind('.');
+  return (dot != std::string::npos) &&
+         ((image.compare(dot, 4, ".hex") == 0) || (image.compare(dot, 4, ".txt") == 0));
+}
+
+static void batch_run(Vpcore_tb* tb, batch_entry &entry) {
+  auto wall_start = std::chrono::steady_clock::now();
+
+  main_time      = 0;
+  exit_valid     = false;
+  exit_code      = 0;
+  skipped_cycles = 0;
+  Verilated::gotFinish(false);
+
+  // Only the memory written by the previous image is zeroed, the cache
+  // tags are cleared by the reset at the start of the image
+  mem_clear_touched();
+  batch_restart(entry.signature.c_str());
+  bool loaded = batch_hex(entry.image) ? mem_image_load_hex(entry.image.c_str())
+                                       : mem_image_load_file(entry.image.c_str(), 0x80000000);
+  if (!loaded) {
+    entry.cycles = 0;
+    entry.secs   = 0;
+    entry.result = "ERROR";
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    printf("[batch] %-7s %12lu cycles %8.2f s  %s\n", entry.result.c_str(),
+           0ul, 0.0, entry.image.c_str());
+    return;
+  }
+  uart_log_open(entry.uart_log.c_str(), 0);
+
+  while (!(done || Verilated::gotFinish()))
+    sim_step(tb);
+
+  uart_log_close();
+
+  entry.cycles = main_time / 10;
+  entry.secs   = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - wall_start).count();
+  if (exit_valid)
+    entry.result = exit_code ? "FAIL" : "PASS";
+  else if (batch_max_cycles && (entry.cycles >= batch_max_cycles))
+    entry.result = "TIMEOUT";
+  else
+    entry.result = "DONE";
+
+  std::lock_guard<std::mutex> lock(batch_mutex);
+  printf("[batch] %-7s %12lu cycles %8.2f s  %s\n", entry.result.c_str(),
+         (unsigned long)entry.cycles, entry.secs, entry.image.c_str());
+}
+
+// Each thread has its own context and model. Batch mode is single-feature
+// by design: the simulation time, exit status, UART log and sparse memory
+// are thread local, while the tracing, profiling and console state of the
+// other bench/*.cpp files is plain static and only safe because batch_main
+// rejects the plusargs that enable it
+static void batch_thread(int argc, char** argv) {
+  VerilatedContext* contextp = new VerilatedContext;
+  contextp->commandArgs(argc, argv);
+  Verilated::threadContextp(contextp);
+
+  Vpcore_tb* tb = new Vpcore_tb{contextp};
+  svSetScope(svGetScopeFromName("TOP.pcore_tb"));
+  tb->clk = 1;
+
+  size_t index;
+  while (!done && ((index = batch_next++) < batch_list.size()))
+    batch_run(tb, batch_list[index]);
+
+  tb->final();
+  delete tb;
+  delete contextp;
+}
+
+static int batch_main(int argc, char** argv, const char *list) {
+  std::ifstream file(list);
+  if (!file) {
+    printf("Cannot read batch list %s\n", list);
+    return EXIT_FAILURE;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    batch_entry entry;
+    if (!(fields >> entry.image) || (entry.image[0] == '#'))
+      continue;
+    fields >> entry.signature;
+    entry.uart_log = entry.image + ".uart.log";
+    batch_list.push_back(entry);
+  }
+
+  // Options that keep a single output file per process
+  const char *unsupported[] = { "trace=", "cosim=", "prof=", "mem_stats=", "cpi=", "timeline=", "bbv=",
+                                "save_cycle=", "save_uart=", "restore=", "imem=", "image=",
+                                "uart_console=" };
+  for (const char *match : unsupported) {
+    if (Verilated::commandArgsPlusMatch(match)[0]) {
+      printf("+%s is not supported in batch mode\n", match);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const char *arg_threads    = Verilated::commandArgsPlusMatch("batch_threads=");
+  const char *arg_max_cycles = Verilated::commandArgsPlusMatch("max_cycles=");
+  unsigned threads = arg_threads[0] ? atoi(arg_threads + 15) : 1;
+  if (arg_max_cycles[0])
+    batch_max_cycles = strtoull(arg_max_cycles + 12, NULL, 0);
+  if (threads < 1)
+    threads = 1;
+
+  signal(SIGINT, INThandler);
+
+  auto wall_start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threads; i++)
+    workers.emplace_back(batch_thread, argc, argv);
+  for (auto &worker : workers)
+    worker.join();
+
+  double wall_secs = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - wall_start).count();
+  unsigned passed = 0, failed = 0, timeouts = 0;
+  for (auto &entry : batch_list) {
+    passed   += (entry.result == "PASS") || (entry.result == "DONE");
+    failed   += (entry.result == "FAIL") || (entry.result == "ERROR");
+    timeouts += (entry.result == "TIMEOUT");
+  }
+  printf("Batch: %zu images, %u passed, %u failed, %u timed out in %.2f s on %u threads\n",
+         batch_list.size(), passed, failed, timeouts, wall_secs, threads);
+
+  return (failed || timeouts || done) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char** argv) {
 
   Verilated::commandArgs(argc, argv);
 
+  const char *arg_batch = Verilated::commandArgsPlusMatch("batch=");
+  if (arg_batch[0])
+    return batch_main(argc, argv, arg_batch + 7);
+
   Vpcore_tb* tb = new Vpcore_tb;
 
-  // init trace dump
-  VerilatedVcdC* tfp = NULL;
-  const char *vcd = Verilated::commandArgsPlusMatch("vcd=");
-  if (atoi(vcd+5)) {
-    Verilated::traceEverOn(true);
-    tfp = new VerilatedVcdC;
-    tb->trace (tfp, 99);
-    tfp->open ("trace.vcd");
+  // Checkpoint options, save at a given cycle or on a UART string match
+  std::string save_file = "pcore.ckpt";
+  vluint64_t  save_cycle = 0;
+  std::string save_uart;
+  bool        save_exit = false;
+  bool        save_pending = false;
+
+  const char *arg_save_file  = Verilated::commandArgsPlusMatch("save_file=");
+  const char *arg_save_cycle = Verilated::commandArgsPlusMatch("save_cycle=");
+  const char *arg_save_uart  = Verilated::commandArgsPlusMatch("save_uart=");
+  const char *arg_save_exit  = Verilated::commandArgsPlusMatch("save_exit=");
+  const char *arg_restore    = Verilated::commandArgsPlusMatch("restore=");
+  if (arg_save_file[0])
+    save_file = arg_save_file + 11;
+  if (arg_save_cycle[0])
+    save_cycle = strtoull(arg_save_cycle + 12, NULL, 0);
+  if (arg_save_uart[0])
+    save_uart = arg_save_uart + 11;
+  if (arg_save_exit[0])
+    save_exit = atoi(arg_save_exit + 11);
+  save_pending = save_cycle || !save_uart.empty();
+
+#ifdef PCORE_SAVABLE
+  if (arg_restore[0])
+    restore_checkpoint(tb, arg_restore + 9);
+#else
+  if (arg_restore[0] || save_pending) {
+    printf("Checkpoints need a model built with savable=1\n");
+    exit(EXIT_FAILURE);
   }
+#endif
+
+  // init trace dump
+  wave_open(tb);
 
   signal(SIGINT, INThandler);
 
-  vluint64_t vcd_start = 0;
-  const char *arg_vcd_start = Verilated::commandArgsPlusMatch("vcd_start=");
-  if (arg_vcd_start[0])
-    vcd_start = atoi(arg_vcd_start+11);
+  // Host console for the UART, transmitted bytes go to stdout and stdin to the receiver
+  const char *arg_uart_console = Verilated::commandArgsPlusMatch("uart_console=");
+  if (arg_uart_console[0] && atoi(arg_uart_console + 14))
+    uart_console_open();
 
-  bool dump = false;
   tb->clk = 1;
 
+  auto wall_start = std::chrono::steady_clock::now();
+  vluint64_t time_start = main_time;
+
   // Simulate 
   while (!(done || Verilated::gotFinish())) {
-    if (tfp && !dump && (main_time > vcd_start)) {
-      dump = true;
+    sim_step(tb);
+
+#ifdef PCORE_SAVABLE
+    // Checkpoints are taken between evals, a restored run continues
+    // with the eval of the pending clock edge
+    if (save_pending &&
+        ((save_cycle && (main_time / 10 >= save_cycle)) ||
+         (!save_uart.empty() && uart_log_ends_with(save_uart.c_str())))) {
+      save_pending = false;
+      save_checkpoint(tb, save_file.c_str());
+      if (save_exit)
+        break;
     }
-    tb->reset = main_time > 100;
-    tb->eval();
-    if (dump)
-      tfp->dump(main_time);
-    tb->clk = !tb->clk;
-    main_time+=5;
+#endif
   }
 
-  if (tfp)
-    tfp->close();
+  // Runs the final blocks, they pass the last accounted cycles
+  tb->final();
+
+  wave_close();
+
+  commit_log_close();
+
+  prof_close();
+
+  mem_stats_close();
+
+  cpi_close();
+
+  timeline_close();
+
+  bbv_close();
+
+  uart_log_close();
+
+  // Report the simulation speed, one clock cycle takes two evals
+  double wall_secs = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - wall_start).count();
+  vluint64_t cycles = (main_time - time_start) / 10;
+  printf("Simulated %lu cycles in %.2f s (%.2f kHz)\n", (unsigned long)cycles,
+         wall_secs, wall_secs > 0 ? cycles / wall_secs / 1000.0 : 0.0);
+
+  if (skipped_cycles)
+    printf("Skipped %lu idle cycles in wfi\n", (unsigned long)skipped_cycles);
+
+#ifdef SPARSE_MEM
+  printf("Sparse memory: %u pages (%u KB)\n", sparse_mem_pages(), sparse_mem_pages() * 4);
+#endif
 
-  exit(EXIT_SUCCESS);
+  if (exit_valid)
+    printf("%s\n", exit_code ? "FAIL" : "PASS");
+  exit(exit_code ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -0,0 +1,69 @@
+/*********************************************************************
+ * Filename :    pcore_tb.h
+ *
+ * Description:  Declarations shared by the C++ testbench components
+ *********************************************************************/
+
+#ifndef PCORE_TB_H
+#define PCORE_TB_H
+
+#include <stdint.h>
+#include "verilated.h"
+#ifdef PCORE_SAVABLE
+#include "verilated_save.h"
+#endif
+
+// Simulation time, one clock cycle takes 10 time units. Kept per thread,
+// the batch mode runs one model on each thread
+extern thread_local vluint64_t main_time;
+
+// ====================== UART log ========================== //
+void     uart_log_open(const char *path, uint64_t pos);
+void     uart_log_close();
+uint64_t uart_log_pos();
+bool     uart_log_ends_with(const char *str);
+void     uart_console_open();
+
+// ====================== Waveform ========================== //
+class Vpcore_tb;
+void     wave_open(Vpcore_tb *tb);
+void     wave_dump(vluint64_t time);
+void     wave_close();
+
+// ====================== Commit log ========================== //
+void     commit_log_close();
+
+// ====================== Profiler ========================== //
+void     prof_close();
+
+// ====================== Memory statistics ========================== //
+void     mem_stats_close();
+
+// ====================== CPI stack ========================== //
+void     cpi_close();
+
+// ====================== Boot timeline ========================== //
+void     timeline_uart(char data);
+void     timeline_close();
+
+// ====================== Basic-block vectors ========================== //
+void     bbv_close();
+
+// ====================== Co-simulation ========================== //
+struct commit_rec;
+bool     cosim_open();
+void     cosim_check(const commit_rec &rec);
+void     cosim_close();
+
+// ====================== Memory images ========================== //
+bool     mem_image_load_file(const char *filename, uint32_t addr);
+bool     mem_image_load_hex(const char *filename);
+
+// ====================== Sparse memory ========================== //
+uint32_t sparse_mem_pages();
+#ifdef PCORE_SAVABLE
+void     sparse_mem_save(VerilatedSave &os);
+void     sparse_mem_restore(VerilatedRestore &os);
+#endif
+
+#endif
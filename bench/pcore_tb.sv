@@ -1,5 +1,8 @@
 `timescale 1 ns / 100 ps
 `include "pcore_interface_defs.svh"
+`include "cache_defs.svh"
+`include "mmu_defs.svh"
+`include "uart_defs.svh"
 
 module pcore_tb(input bit clk, input bit reset);
 
@@ -8,10 +11,92 @@ reg                       irq_soft;
 reg                       uart_rx;
 wire                      uart_tx;
 logic                     spi_clk, spi_cs, spi_mosi, spi_miso;
-reg [1023:0]              firmware;
+string                    firmware;
+string                    image;
+string                    boot_image;
+reg [31:0]                image_addr = 32'h80000000;
 reg [1023:0]              max_cycles;
 reg [1023:0]              main_time = '0;
 
+// Host side testbench functions implemented in bench/*.cpp
+import "DPI-C" function void uart_tx_byte(input byte data);
+import "DPI-C" function void mem_image_load(input string filename, input int addr);
+import "DPI-C" function void sim_exit(input int code, input string reason);
+import "DPI-C" function void sim_skip(input longint cycles);
+import "DPI-C" function void wave_trigger(input bit on);
+import "DPI-C" function int  commit_log_enabled();
+import "DPI-C" function void commit_retire(input longint cycle, input int pc, input int instr, input int rd_addr,
+                                           input int mem_addr, input int mem_data, input int flags);
+import "DPI-C" function void commit_wrb(input int rd_addr, input int rd_data);
+import "DPI-C" function void commit_trap(input longint cycle, input int pc, input int instr, input int cause, input int priv);
+import "DPI-C" function int  prof_enabled();
+import "DPI-C" function void prof_frame(input int pc);
+import "DPI-C" function void prof_sample(input int pc, input int priv, input int satp);
+import "DPI-C" function int  mem_stats_enabled();
+import "DPI-C" function void mem_stats_event(input longint cycle, input int events);
+import "DPI-C" function int  cpi_enabled();
+import "DPI-C" function void cpi_account(input int pc, input int category, input longint cycles);
+import "DPI-C" function int  timeline_enabled();
+import "DPI-C" function void timeline_priv(input longint cycle, input int priv);
+import "DPI-C" function void timeline_satp(input longint cycle, input int satp);
+import "DPI-C" function int  bbv_enabled();
+import "DPI-C" function void bbv_block(input longint cycle, input int pc, input int count);
+`ifdef SPARSE_MEM
+import "DPI-C" function int  sparse_mem_read(input int word_addr);
+import "DPI-C" function void sparse_mem_write(input int word_addr, input int data);
+import "DPI-C" function void sparse_mem_load_hex(input string filename);
+import "DPI-C" function void sparse_mem_clear();
+`endif
+
+// Memory write used by the image loader, the address decides between
+// main memory and boot memory
+export "DPI-C" function mem_write_word;
+
+function void mem_write_word(input int addr, input int data);
+  if (addr[`DMEM_SEL_ADDR_HIGH:`DMEM_SEL_ADDR_LOW] == `DMEM_ADDR_MATCH)
+`ifdef SPARSE_MEM
+    sparse_mem_write(addr[`MEM_ADDR_WIDTH-1:2], data);
+`else
+  begin
+    dut.mem_top_module.main_mem_module.dualport_memory[addr[`MEM_ADDR_WIDTH-1:2]] = data;
+    dut.mem_top_module.main_mem_module.mem_touched[addr[`MEM_ADDR_WIDTH-1:12]]   = 1'b1;
+  end
+`endif
+  else if (addr[`BMEM_SEL_ADDR_HIGH:`BMEM_SEL_ADDR_LOW] == `BMEM_ADDR_MATCH)
+    dut.mem_top_module.bmem_interface_module.bmem_module.bmem_image[addr[11:2]] = data;
+endfunction
+
+// Main memory read used by the co-simulation reference model to fill
+// its memory on first access
+export "DPI-C" function mem_read_word;
+
+function int mem_read_word(input int addr);
+`ifdef SPARSE_MEM
+  return sparse_mem_read(addr[`MEM_ADDR_WIDTH-1:2]);
+`else
+  return dut.mem_top_module.main_mem_module.dualport_memory[addr[`MEM_ADDR_WIDTH-1:2]];
+`endif
+endfunction
+
+// Batch mode of the testbench, the main memory pages written by the previous
+// image are zeroed and the cycle count restarts before the next image
+export "DPI-C" function mem_clear_touched;
+export "DPI-C" function batch_restart;
+
+function void mem_clear_touched();
+`ifdef SPARSE_MEM
+  sparse_mem_clear();
+`else
+  for (int page = 0; page < (1 << (`MEM_ADDR_WIDTH-12)); page++) begin
+    if (dut.mem_top_module.main_mem_module.mem_touched[page]) begin
+      for (int i = 0; i < 1024; i++)
+        dut.mem_top_module.main_mem_module.dualport_memory[page*1024 + i] = '0;
+      dut.mem_top_module.main_mem_module.mem_touched[page] = 1'b0;
+    end
+  end
+`endif
+endfunction
+
 soc_top dut (
   .clk                     (clk),
   .rst_n                   (reset),
@@ -25,6 +110,247 @@ soc_top dut (
   .spi_mosi_o              (spi_mosi)
 ); 
 
+// ====================== Instruction retirement ========================== //
+
+// Instructions retire at the CSR stage, under the same condition as minstret
+`define CSR_TB dut.core_top_module.pipeline_top_module.csr_module
+`define FWD_TB dut.core_top_module.pipeline_top_module.forward_stall_module
+`define IF_TB  dut.core_top_module.pipeline_top_module.fetch_module
+
+// Fetch passes a nop down the pipeline while the icache has not acked, it
+// is not flagged as flushed. A valid bit follows the IF/ID, ID/EXE and 
+// EXE/CSR pipeline registers to tell it apart from an instruction
+logic       instr_valid_id, instr_valid_exe, instr_valid_csr;
+wire        instr_valid_if = `IF_TB.icache2if.ack | `IF_TB.irq_req_next;
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    instr_valid_id  <= 1'b0;
+    instr_valid_exe <= 1'b0;
+    instr_valid_csr <= 1'b0;
+  end else begin
+    if (`FWD_TB.fwd2ptop.if2id_pipe_flush)
+      instr_valid_id <= 1'b0;
+    else if (~`FWD_TB.fwd2ptop.if2id_pipe_stall)
+      instr_valid_id <= instr_valid_if;
+
+    if (`FWD_TB.fwd2ptop.id2exe_pipe_flush)
+      instr_valid_exe <= 1'b0;
+    else if (~`FWD_TB.fwd2ptop.id2exe_pipe_stall)
+      instr_valid_exe <= instr_valid_id;
+
+    // The CSR stage data is not held on an LSU stall, like exe2csr_data_pipe_ff
+    if (`FWD_TB.fwd2ptop.exe2lsu_pipe_flush)
+      instr_valid_csr <= 1'b0;
+    else
+      instr_valid_csr <= instr_valid_exe;
+  end
+end
+
+wire        retire_valid = reset & ~`CSR_TB.pipe_stall_flush & instr_valid_csr &
+                           ~(`CSR_TB.exc_req & `CSR_TB.is_not_ecall & `CSR_TB.is_not_ebreak);
+wire [31:0] retire_pc    = `CSR_TB.exe2csr_data.pc;
+wire [31:0] retire_instr = `CSR_TB.exe2csr_data.instr;
+
+// ====================== Commit log ========================== //
+
+// Retired instructions, their register writes and traps are passed to
+// bench/commit_log.cpp when +trace=<file> is given. The LSU stage holds
+// the memory access of the instruction retiring at the CSR stage, its
+// register write reaches writeback one or more cycles later
+`define PIPE_TB dut.core_top_module.pipeline_top_module
+
+bit          commit_en;
+initial      commit_en = commit_log_enabled();
+
+wire         commit_irq   = `CSR_TB.csr2fwd.irq_flush_lsu;
+wire         commit_trap_req = reset & (`CSR_TB.m_mode_exc_req | `CSR_TB.s_mode_exc_req | 
+                                        `CSR_TB.m_mode_irq_req | `CSR_TB.s_mode_irq_req);
+wire [31:0]  commit_cause = commit_irq ? {1'b1, 27'b0, `CSR_TB.irq_code} : {28'b0, `CSR_TB.exc_code};
+
+type_exe2lsu_ctrl_s commit_lsu_ctrl;
+logic [4:0]         commit_rd_addr;
+logic [1:0]         commit_mem_size;
+logic               commit_load, commit_store;
+
+assign commit_lsu_ctrl = `PIPE_TB.exe2lsu_ctrl_pipe_ff;
+assign commit_rd_addr  = commit_lsu_ctrl.rd_wr_req ? commit_lsu_ctrl.rd_addr : '0;
+assign commit_load     = (commit_lsu_ctrl.ld_ops != LD_OPS_NONE) | (commit_lsu_ctrl.amo_ops != AMO_OPS_NONE);
+assign commit_store    = (commit_lsu_ctrl.st_ops != ST_OPS_NONE);
+
+always_comb begin
+  case (1'b1)
+    (commit_lsu_ctrl.ld_ops == LD_OPS_LB) | (commit_lsu_ctrl.ld_ops == LD_OPS_LBU) |
+    (commit_lsu_ctrl.st_ops == ST_OPS_SB) : commit_mem_size = 2'd0;
+    (commit_lsu_ctrl.ld_ops == LD_OPS_LH) | (commit_lsu_ctrl.ld_ops == LD_OPS_LHU) |
+    (commit_lsu_ctrl.st_ops == ST_OPS_SH) : commit_mem_size = 2'd1;
+    default                               : commit_mem_size = 2'd2;
+  endcase
+end
+
+always_ff@(posedge clk) begin
+  if (commit_en) begin
+    // Writes of earlier instructions are matched before a new retirement
+    if (`PIPE_TB.wrb2id_fb.rd_wr_req & (|`PIPE_TB.wrb2id_fb.rd_addr))
+      commit_wrb(`PIPE_TB.wrb2id_fb.rd_addr, `PIPE_TB.wrb2id_fb.rd_data);
+    // The instruction at the CSR stage does not complete when an interrupt is taken
+    if (retire_valid & ~commit_irq)
+      commit_retire(main_time[63:0], retire_pc, retire_instr, commit_rd_addr,
+                    `PIPE_TB.exe2lsu_data_pipe_ff.alu_result, `PIPE_TB.exe2lsu_data_pipe_ff.rs2_data,
+                    {`CSR_TB.priv_mode_ff, 1'b0, commit_mem_size, 2'b0, commit_store, commit_load, 1'b0});
+    if (commit_trap_req)
+      commit_trap(main_time[63:0], retire_pc, retire_instr, commit_cause, `CSR_TB.priv_mode_ff);
+  end
+end
+
+// ====================== PC sampling profiler ========================== //
+
+// With +prof=<file> the last retired PC, privilege mode and satp are sampled
+// every prof_period cycles (+prof_period=<N>, default 1000) together with a
+// shadow call stack of the call sites, see bench/profile.cpp
+int unsigned prof_period = 1000;
+int unsigned prof_count;
+bit          prof_en;
+logic [31:0] prof_pc;
+logic [31:0] prof_stack[64];
+logic [6:0]  prof_depth;
+
+initial begin
+  prof_en = prof_enabled();
+  void'($value$plusargs("prof_period=%d", prof_period));
+  // A period of 0 would never match the countdown, sample every cycle
+  if (prof_period == 0)
+    prof_period = 1;
+end
+
+// Calls and returns follow the link register hints of the ISA, traps and
+// returns from traps are handled as calls and returns
+wire [6:0]   prof_opcode  = retire_instr[6:0];
+wire [4:0]   prof_rd      = retire_instr[11:7];
+wire [4:0]   prof_rs1     = retire_instr[19:15];
+wire         prof_rd_link = (prof_rd == 5'd1) | (prof_rd == 5'd5);
+wire         prof_rs_link = (prof_rs1 == 5'd1) | (prof_rs1 == 5'd5);
+wire         prof_call    = retire_valid & (((prof_opcode == 7'b1101111) & prof_rd_link) | 
+                                            ((prof_opcode == 7'b1100111) & prof_rd_link));
+wire         prof_ret     = retire_valid & (((prof_opcode == 7'b1100111) & prof_rs_link & ~prof_rd_link) |
+                                            (retire_instr == 32'h30200073) | (retire_instr == 32'h10200073));
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    prof_depth <= '0;
+    prof_count <= '0;
+  end else if (prof_en) begin
+    if (retire_valid)
+      prof_pc <= retire_pc;
+
+    if (commit_trap_req | prof_call) begin
+      if (prof_depth < 64)
+        prof_stack[prof_depth[5:0]] <= retire_pc;
+      if (prof_depth != 7'h7f)
+        prof_depth <= prof_depth + 1;
+    end else if (prof_ret & (prof_depth != 0)) begin
+      prof_depth <= prof_depth - 1;
+    end
+
+    if (prof_count == prof_period - 1) begin
+      for (int i = 0; i < 64; i++)
+        if (i < prof_depth)
+          prof_frame(prof_stack[i]);
+      prof_sample(prof_pc, `CSR_TB.priv_mode_ff, `CSR_TB.csr_satp_ff);
+      prof_count <= '0;
+    end else begin
+      prof_count <= prof_count + 1;
+    end
+  end
+end
+
+// ====================== Memory hierarchy statistics ========================== //
+
+// With +mem_stats the cache, TLB, page table walker and memory arbiter
+// events of each cycle are passed to bench/mem_stats.cpp as a bit mask,
+// the bit order follows mem_stats_names[] there
+`define ICACHE_TB dut.mem_top_module.icache_top_module
+`define DCACHE_TB dut.mem_top_module.wb_dcache_top_module.wb_dcache_controller_module
+`define PTW_TB    dut.core_top_module.mmu_module.ptw_module
+`define MEM_TB    dut.mem_top_module
+
+bit          mem_stats_en;
+initial      mem_stats_en = mem_stats_enabled();
+
+// The lookup that completes a refill hits, it is part of the miss
+logic        stats_icache_refill, stats_dcache_refill;
+logic [17:0] stats_events;
+
+wire stats_icache_idle  = (`ICACHE_TB.icache_state_ff == ICACHE_IDLE);
+wire stats_icache_read  = (`ICACHE_TB.icache_state_ff == ICACHE_READ_MEMORY);
+wire stats_dcache_req   = (`DCACHE_TB.dcache_state_ff == DCACHE_PROCESS_REQ);
+wire stats_dcache_alloc = (`DCACHE_TB.dcache_state_ff == DCACHE_ALLOCATE);
+wire stats_dcache_wrb   = (`DCACHE_TB.dcache_state_ff == DCACHE_WRITE_BACK);
+wire stats_dcache_flush = (`DCACHE_TB.dcache_state_ff == DCACHE_FLUSH_NEXT) |
+                          (`DCACHE_TB.dcache_state_ff == DCACHE_FLUSH) |
+                          (`DCACHE_TB.dcache_state_ff == DCACHE_FLUSH_DONE);
+wire stats_ptw_idle     = (`PTW_TB.ptw_state_ff == PTW_IDLE);
+wire stats_arb_idle     = (`MEM_TB.mem_arbiter_state_ff == MEM_ARBITER_IDLE);
+wire stats_arb_dcache   = (`MEM_TB.mem_arbiter_state_ff == MEM_ARBITER_DCACHE);
+wire stats_arb_icache   = (`MEM_TB.mem_arbiter_state_ff == MEM_ARBITER_ICACHE);
+wire stats_arb_dkill    = (`MEM_TB.mem_arbiter_state_ff == MEM_ARBITER_DKILL);
+wire stats_arb_ikill    = (`MEM_TB.mem_arbiter_state_ff == MEM_ARBITER_IKILL);
+wire stats_mem_ack      = `MEM_TB.mem2cache.ack;
+
+always_comb begin
+  stats_events[0]  = stats_icache_idle & `ICACHE_TB.icache_hit & ~stats_icache_refill;
+  stats_events[1]  = stats_icache_idle & `ICACHE_TB.icache2mem.req;
+  stats_events[2]  = stats_icache_read;
+  stats_events[3]  = stats_dcache_req & `DCACHE_TB.dcache_hit & ~stats_dcache_refill;
+  stats_events[4]  = stats_dcache_req & `DCACHE_TB.dcache_miss;
+  stats_events[5]  = stats_dcache_alloc | (stats_dcache_wrb & ~`DCACHE_TB.dcache_flush_i);
+  stats_events[6]  = stats_dcache_wrb & `DCACHE_TB.mem2dcache_ack_i;
+  stats_events[7]  = stats_dcache_flush | (stats_dcache_wrb & `DCACHE_TB.dcache_flush_i);
+  stats_events[8]  = stats_ptw_idle & `PTW_TB.itlb_miss;
+  stats_events[9]  = stats_ptw_idle & ~`PTW_TB.itlb_miss & `PTW_TB.dtlb_miss;
+  stats_events[10] = ~stats_ptw_idle;
+  stats_events[11] = stats_arb_idle & ~`MEM_TB.dcache2mem.req & `MEM_TB.icache2mem.req;
+  stats_events[12] = stats_arb_idle & `MEM_TB.dcache2mem.req;
+  stats_events[13] = `MEM_TB.icache2mem.req & ((stats_arb_idle & `MEM_TB.dcache2mem.req) |
+                                               stats_arb_dcache | stats_arb_dkill);
+  stats_events[14] = `MEM_TB.dcache2mem.req & (stats_arb_icache | stats_arb_ikill);
+  stats_events[15] = stats_arb_icache & `MEM_TB.if2icache.req_kill;
+  stats_events[16] = stats_arb_dcache & `MEM_TB.dcache2mem_kill;
+  stats_events[17] = `MEM_TB.timeout_flag & ~stats_mem_ack &
+                     ((stats_arb_icache & ~`MEM_TB.if2icache.req_kill) | stats_arb_ikill | stats_arb_dkill);
+end
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    stats_icache_refill <= 1'b0;
+    stats_dcache_refill <= 1'b0;
+  end else if (mem_stats_en) begin
+    stats_icache_refill <= stats_icache_read & `ICACHE_TB.mem2icache.ack;
+    stats_dcache_refill <= stats_dcache_alloc ? `DCACHE_TB.mem2dcache_ack_i :
+                           stats_dcache_refill & ~stats_dcache_req;
+    if (|stats_events)
+      mem_stats_event(main_time[63:0], {14'b0, stats_events});
+  end
+end
+
+// ====================== Waveform triggers ========================== //
+
+// The waveform dump is armed and disarmed when the given PCs retire
+logic [31:0] wave_pc_on, wave_pc_off;
+logic        wave_pc_on_en, wave_pc_off_en;
+
+initial begin
+  wave_pc_on_en  = $value$plusargs("vcd_pc_on=%h", wave_pc_on);
+  wave_pc_off_en = $value$plusargs("vcd_pc_off=%h", wave_pc_off);
+end
+
+always_ff@(posedge clk) begin
+  if (retire_valid & wave_pc_on_en & (retire_pc == wave_pc_on))
+    wave_trigger(1'b1);
+  if (retire_valid & wave_pc_off_en & (retire_pc == wave_pc_off))
+    wave_trigger(1'b0);
+end
+
 initial begin
   irq_ext   = 0;
   irq_soft  = 0;
@@ -34,7 +360,23 @@ initial begin
   // Load hex instructions
   if($value$plusargs("imem=%s",firmware)) begin
     $display("Loading Instruction Memory from %0s", firmware);
+`ifdef SPARSE_MEM
+    sparse_mem_load_hex(firmware);
+`else
     $readmemh(firmware, dut.mem_top_module.main_mem_module.dualport_memory);
+`endif
+  end
+
+  // Load ELF segments or a raw binary directly, raw images are placed at image_addr
+  void'($value$plusargs("image_addr=%h",image_addr));
+  if($value$plusargs("image=%s",image)) begin
+    $display("Loading memory image from %0s", image);
+    mem_image_load(image, image_addr);
+  end
+
+  if($value$plusargs("bmem=%s",boot_image)) begin
+    $display("Loading boot memory image from %0s", boot_image);
+    mem_image_load(boot_image, 32'h00001000);
   end
 
   if($value$plusargs("max_cycles=%d",max_cycles)) begin
@@ -44,42 +386,342 @@ end
 
 always_ff@(posedge clk ) begin
   if(main_time < max_cycles) begin
-    main_time <= main_time + 1;
+    main_time <= main_time + 1 + wfi_ffwd_skip;
   end else begin
     $display("Timeout: Exiting after %0d cycles\n", main_time);
     $finish;
   end
 end
 
+// ====================== Simulation exit ========================== //
+
+// Store to the simulation exit register decoded by dbus_interconnect
+wire sim_exit_en = dut.dbus_interconnect_module.sim_ctrl_sel & 
+                   dut.dbus_interconnect_module.sim_ctrl_ack_ff & dut.dbus2peri.w_en;
+
+// The core waits in wfi while no enabled interrupt can wake it up
+localparam WFI_HANG_CYCLES = 10000;
+
+wire wfi_hang = `CSR_TB.wfi_ff & 
+               ~((`CSR_TB.csr_mie_ff.seie | `CSR_TB.csr_mie_ff.stie | `CSR_TB.csr_mie_ff.ssie) |
+                ((`CSR_TB.csr_mie_ff.meie | `CSR_TB.csr_mie_ff.mtie | `CSR_TB.csr_mie_ff.msie) & 
+                  `CSR_TB.m_mode_global_ie));
+logic [31:0] wfi_hang_count;
+
+always_ff@(posedge clk) begin
+  if (~reset | ~wfi_hang)
+    wfi_hang_count <= '0;
+  else
+    wfi_hang_count <= wfi_hang_count + 1;
+
+  if (sim_exit_en) begin
+    sim_exit(dut.dbus2peri.w_data, "exit register");
+    $finish;
+  end else if (wfi_hang_count == WFI_HANG_CYCLES) begin
+    sim_exit(-1, "hang in wfi with interrupts disabled");
+    $finish;
+  end
+end
+
+// ====================== WFI fast-forward ========================== //
+
+// With +wfi_ffwd=1 the idle cycles of a core waiting in wfi for the timer 
+// interrupt are skipped, mtime, mcycle and the simulation time jump close
+// to the next mtimecmp deadline in a single cycle
+localparam WFI_FFWD_IDLE_CYCLES = 16;
+localparam WFI_FFWD_MARGIN      = 2;
+
+logic        wfi_ffwd_en;
+logic        wfi_ffwd_req;
+logic [63:0] wfi_ffwd_skip;
+logic [7:0]  wfi_idle_count;
+
+initial begin
+  wfi_ffwd_en = $test$plusargs("wfi_ffwd=1");
+end
+
+// Core is parked in wfi, the timer can wake it up and no peripheral activity is pending
+wire wfi_idle = `CSR_TB.wfi_ff & `CSR_TB.csr_mie_ff.mtie & 
+                dut.uart_module.tx_ready & uart_rx & 
+               (dut.uart_module.uart_rx_module.state_ff == UART_RX_IDLE) &
+               ~(dut.irq_plic_target_0 | dut.irq_plic_target_1 | irq_ext | irq_soft) & 
+                (dut.clint_module.mtimecmp_ff > dut.clint_module.mtime_ff + WFI_FFWD_MARGIN);
+
+assign wfi_ffwd_req  = wfi_ffwd_en & wfi_idle & (wfi_idle_count == WFI_FFWD_IDLE_CYCLES);
+assign wfi_ffwd_skip = wfi_ffwd_req ? (dut.clint_module.mtimecmp_ff - dut.clint_module.mtime_ff - WFI_FFWD_MARGIN) : '0;
+
+// The skip is applied by the next clock edge, the idle count restarts 
+// so that the old mtime is not used twice
+always_ff@(posedge clk) begin
+  dut.clint_module.sim_skip_cycles <= wfi_ffwd_skip;
+  `CSR_TB.sim_skip_cycles          <= wfi_ffwd_skip;
+
+  if (~reset | ~wfi_ffwd_en | ~wfi_idle | wfi_ffwd_req)
+    wfi_idle_count <= '0;
+  else
+    wfi_idle_count <= wfi_idle_count + 1;
+
+  if (wfi_ffwd_req)
+    sim_skip(wfi_ffwd_skip);
+end
+
+// ====================== CPI stack ========================== //
+
+// Bubbles in the pipeline registers carry the cause that created them,
+// they follow the registers like instr_valid. A fetch nop is tagged with
+// the miss or redirect the fetch stage is waiting for
+typedef enum logic [2:0] {
+  CPI_RETIRE, CPI_FETCH, CPI_BRANCH, CPI_LOAD_USE, CPI_LSU, CPI_MEXT, CPI_TRAP, CPI_WFI
+} type_cpi_e;
+
+type_cpi_e  bubble_if, bubble_id, bubble_exe, bubble_csr;
+type_cpi_e  bubble_flush, bubble_redirect;
+
+assign bubble_flush = `FWD_TB.csr2fwd.new_pc_req ? CPI_TRAP :
+                      `FWD_TB.csr2fwd.wfi_req    ? CPI_WFI  : CPI_BRANCH;
+
+// Fetch bubbles after a redirect are part of it, unless the icache or the 
+// page table walker is serving a miss
+assign bubble_if = (`IF_TB.icache2if.ack | `IF_TB.irq_req_next)              ? CPI_RETIRE :
+                   ((bubble_redirect == CPI_RETIRE) | `PTW_TB.iwalk_active_ff |
+                    (`ICACHE_TB.icache_state_ff == ICACHE_READ_MEMORY))       ? CPI_FETCH  : bubble_redirect;
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    bubble_redirect <= CPI_RETIRE;
+    bubble_id       <= CPI_RETIRE;
+    bubble_exe      <= CPI_RETIRE;
+    bubble_csr      <= CPI_RETIRE;
+  end else begin
+    if (`FWD_TB.id_exe_flush)
+      bubble_redirect <= bubble_flush;
+    else if (`IF_TB.icache2if.ack)
+      bubble_redirect <= CPI_RETIRE;
+
+    if (`FWD_TB.fwd2ptop.if2id_pipe_flush)
+      bubble_id <= bubble_flush;
+    else if (~`FWD_TB.fwd2ptop.if2id_pipe_stall)
+      bubble_id <= bubble_if;
+
+    if (`FWD_TB.fwd2ptop.id2exe_pipe_flush)
+      bubble_exe <= bubble_flush;
+    else if (~`FWD_TB.fwd2ptop.id2exe_pipe_stall)
+      bubble_exe <= bubble_id;
+
+    // The CSR stage data is not held on an LSU stall, like exe2csr_data_pipe_ff
+    if (`FWD_TB.fwd2ptop.exe2lsu_pipe_flush)
+      bubble_csr <= `FWD_TB.lsu_flush ? bubble_flush : CPI_LOAD_USE;
+    else
+      bubble_csr <= bubble_exe;
+  end
+end
+
+// With +cpi every cycle is assigned to one category by what the CSR stage
+// holds: a retiring instruction, a stall of the LSU or M-extension unit, a
+// trap, or a bubble with the cause it carries. Cycles are accounted to the
+// last retired PC in runs of the same PC and category, see bench/cpi_stack.cpp
+bit          cpi_en;
+initial      cpi_en = cpi_enabled();
+
+type_cpi_e   cpi_class, cpi_run_class;
+logic [31:0] cpi_last_pc, cpi_run_pc;
+longint      cpi_run_cycles = 0;
+
+wire  [31:0] cpi_pc = retire_valid ? retire_pc : cpi_last_pc;
+
+always_comb begin
+  if (`CSR_TB.wfi_ff)
+    cpi_class = CPI_WFI;
+  else if (`FWD_TB.lsu_div_stall_ff)
+    cpi_class = `FWD_TB.div_stall_ff ? CPI_MEXT : CPI_LSU;
+  else if (retire_valid)
+    cpi_class = CPI_RETIRE;
+  else if (commit_trap_req | (bubble_csr == CPI_RETIRE))
+    cpi_class = CPI_TRAP;
+  else
+    cpi_class = bubble_csr;
+end
+
+always_ff@(posedge clk) begin
+  if (cpi_en & reset) begin
+    if (retire_valid)
+      cpi_last_pc <= retire_pc;
+
+    if ((cpi_class != cpi_run_class) | (cpi_pc != cpi_run_pc)) begin
+      if (cpi_run_cycles != 0)
+        cpi_account(cpi_run_pc, cpi_run_class, cpi_run_cycles);
+      cpi_run_class  <= cpi_class;
+      cpi_run_pc     <= cpi_pc;
+      cpi_run_cycles <= 1;
+    end else begin
+      cpi_run_cycles <= cpi_run_cycles + 1;
+    end
+
+    if (wfi_ffwd_req)
+      cpi_account(cpi_pc, CPI_WFI, wfi_ffwd_skip);
+  end
+end
+
+final begin
+  if (cpi_en & (cpi_run_cycles != 0))
+    cpi_account(cpi_run_pc, cpi_run_class, cpi_run_cycles);
+end
+
+// ====================== Boot timeline ========================== //
+
+// With +timeline the privilege mode and satp changes are passed to
+// bench/boot_timeline.cpp, which timestamps them together with the UART
+// milestones and prints the timeline at exit
+bit          timeline_en;
+initial      timeline_en = timeline_enabled();
+
+logic [1:0]  timeline_priv_ff;
+logic [31:0] timeline_satp_ff;
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    timeline_priv_ff <= PRIV_MODE_M;
+    timeline_satp_ff <= '0;
+  end else if (timeline_en) begin
+    timeline_priv_ff <= `CSR_TB.priv_mode_ff;
+    timeline_satp_ff <= `CSR_TB.csr_satp_ff;
+    if (`CSR_TB.priv_mode_ff != timeline_priv_ff)
+      timeline_priv(main_time[63:0], `CSR_TB.priv_mode_ff);
+    if (`CSR_TB.csr_satp_ff != timeline_satp_ff)
+      timeline_satp(main_time[63:0], `CSR_TB.csr_satp_ff);
+  end
+end
+
+// ====================== Basic-block vectors ========================== //
+
+// With +bbv=<file> the retired instructions are split into basic blocks,
+// each executed block is passed to bench/bbv.cpp with the cycle its first
+// instruction retired. A block ends after a branch, jump or SYSTEM
+// instruction, and before an instruction that does not follow the previous
+// one, as the first instruction of a trap handler
+bit          bbv_en;
+initial      bbv_en = bbv_enabled();
+
+logic [31:0] bbv_start_pc, bbv_next_pc;
+longint      bbv_start_cycle;
+int unsigned bbv_count;
+
+wire         bbv_retire = retire_valid & ~commit_irq;
+wire [6:0]   bbv_opcode = retire_instr[6:0];
+wire         bbv_end    = (bbv_opcode == 7'b1100011) | (bbv_opcode == 7'b1101111) |
+                          (bbv_opcode == 7'b1100111) | (bbv_opcode == 7'b1110011);
+wire         bbv_break  = (bbv_count != 0) & (retire_pc != bbv_next_pc);
+wire         bbv_first  = (bbv_count == 0) | bbv_break;
+
+always_ff@(posedge clk) begin
+  if (~reset) begin
+    bbv_count <= '0;
+  end else if (bbv_en & bbv_retire) begin
+    if (bbv_break)
+      bbv_block(bbv_start_cycle, bbv_start_pc, bbv_count);
+
+    if (bbv_end) begin
+      bbv_block(bbv_first ? main_time[63:0] : bbv_start_cycle, bbv_first ? retire_pc : bbv_start_pc,
+                bbv_first ? 1 : bbv_count + 1);
+      bbv_count <= '0;
+    end else begin
+      if (bbv_first) begin
+        bbv_start_pc    <= retire_pc;
+        bbv_start_cycle <= main_time[63:0];
+      end
+      bbv_count <= bbv_first ? 1 : bbv_count + 1;
+    end
+    bbv_next_pc <= retire_pc + 4;
+  end
+end
+
+final begin
+  if (bbv_en & (bbv_count != 0))
+    bbv_block(bbv_start_cycle, bbv_start_pc, bbv_count);
+end
+
 `ifndef COMPLIANCE
 /*    Logic to dump UART logs, instruction trace or any other type 
       of logs must be added here      */
 
 // ====================== UART logs ========================== //
 
-integer     uartlog_filepointer;
+// The log file is kept by the C++ testbench (bench/uart_log.cpp) so
+// that its position survives a checkpoint/restore of the model
+always_ff@(posedge clk) begin
+  if (dut.uart_module.tx_valid_ff == 1)
+    uart_tx_byte(dut.uart_module.uart_reg_tx_ff);
+end
+
+// ====================== UART console input ========================== //
 
-initial begin
-  uartlog_filepointer = $fopen("uart_logdata.log", "w");
+// Bytes typed on the host console (+uart_console=1) are passed to the UART 
+// receiver, one byte at a time while the rx fifo has space
+import "DPI-C" function int uart_rx_byte();
+
+int          uart_rx_data;
+wire         uart_rx_ready = reset & ~dut.uart_module.fifo_full;
+
+`ifdef UART_FAST
+// Received bytes are written to the rx fifo directly
+always_ff@(posedge clk) begin
+  dut.uart_module.sim_rx_valid <= 1'b0;
+  if (uart_rx_ready & ~dut.uart_module.sim_rx_valid) begin
+    uart_rx_data = uart_rx_byte();
+    if (uart_rx_data >= 0) begin
+      dut.uart_module.sim_rx_valid <= 1'b1;
+      dut.uart_module.sim_rx_byte  <= uart_rx_data[7:0];
+    end
+  end
 end
+`else
+// Received bytes are sent serially on the rx pin, with start bit, 8 data 
+// bits and two stop bits at the configured baud rate
+logic [10:0] uart_rx_frame;
+logic [3:0]  uart_rx_bits;
+logic [15:0] uart_rx_count;
 
 always_ff@(posedge clk) begin
-  if (dut.uart_module.tx_valid_ff == 1)
-    $fwrite(uartlog_filepointer, "%c", dut.uart_module.uart_reg_tx_ff);
+  if (~reset) begin
+    uart_rx       <= 1'b1;
+    uart_rx_bits  <= '0;
+    uart_rx_count <= '0;
+  end else if (uart_rx_bits != 0) begin
+    if (uart_rx_count == dut.uart_module.uart_reg_baud_ff - 1) begin
+      uart_rx       <= uart_rx_frame[0];
+      uart_rx_frame <= {1'b1, uart_rx_frame[10:1]};
+      uart_rx_bits  <= uart_rx_bits - 1;
+      uart_rx_count <= '0;
+    end else begin
+      uart_rx_count <= uart_rx_count + 1;
+    end
+  end else if (uart_rx_ready & (dut.uart_module.uart_rx_module.state_ff == UART_RX_IDLE)) begin
+    uart_rx_data = uart_rx_byte();
+    if (uart_rx_data >= 0) begin
+      uart_rx_frame <= {2'b11, uart_rx_data[7:0], 1'b0};
+      uart_rx_bits  <= 4'd11;
+      uart_rx_count <= dut.uart_module.uart_reg_baud_ff - 1;
+    end
+  end
 end
+`endif
 
 `else
 // ====================== For RISC-V architecture tests ========================== //
 
-wire sig_en  = (dut.dbus2peri.addr == 32'h8E000000) & dut.mem_top_module.wb_dcache_top_module.cache_wr;
-wire halt_en = (dut.dbus2peri.addr == 32'h8F000000) & dut.mem_top_module.wb_dcache_top_module.cache_wr;
+// Stores are observed when they enter the store buffer, where stores to the same word merge
+wire sig_en  = (dut.dbus2peri.addr == 32'h8E000000) & dut.mem_top_module.store_buffer_module.st_wr;
+wire halt_en = (dut.dbus2peri.addr == 32'h8F000000) & dut.mem_top_module.store_buffer_module.st_wr;
   
-reg [1023:0] signature_file;
+string  signature_file;
 
 integer write_sig=0;
   
 initial begin
-  write_sig = $fopen("DUT-pcore.signature", "w"); // Open file for writing
+  // The signature path is given by +signature=<file> so that tests can run in parallel
+  if (!$value$plusargs("signature=%s", signature_file))
+    signature_file = "DUT-pcore.signature";
+  write_sig = $fopen(signature_file, "w"); // Open file for writing
   if (write_sig == 0) begin
     $display("Error opening file for writing");
     $finish;
@@ -92,9 +734,22 @@ always_ff@(posedge clk) begin
   else if(halt_en) begin
     $display("Test Complete");
     $fclose(write_sig);
+    write_sig = 0;
     $finish;
   end
 end
 
 `endif 
+
+// Restart for the next image of a batch, the signature file of the 
+// architecture tests is given per image
+function void batch_restart(input string signature);
+  main_time = '0;
+`ifdef COMPLIANCE
+  if (write_sig != 0)
+    $fclose(write_sig);
+  write_sig = (signature != "") ? $fopen(signature, "w") : 0;
+`endif
+endfunction
+
 endmodule
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+#*********************************************************************
+#  * Filename :    perf_regression.py
+#  *
+#  * Description:  Runs benchmark images on the Verilator model in batch
+#  *               mode, reads the "cycles=<N> instret=<N>" line of each
+#  *               UART log, with the branch and return misprediction
+#  *               rates when the line has them, and compares the cycles with a stored
+#  *               baseline. A benchmark that fails, or that takes more
+#  *               cycles than the baseline by more than the tolerance,
+#  *               gives a failing exit status. --update records the
+#  *               counts as the new baseline
+#  *
+#  * Usage:        perf_regression.py image.elf... [--model PATH]
+#  *                   [--baseline FILE] [--tolerance PERCENT]
+#  *                   [--threads N] [--max-cycles N] [--update]
+#  *********************************************************************
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+PERF_LINE  = re.compile(r'cycles=(\d+) instret=(\d+)(?: branches=(\d+) mispredicts=(\d+))?'
+                        r'(?: returns=(\d+) ret_mispredicts=(\d+))?')
+BATCH_LINE = re.compile(r'^\[batch\] (\S+)\s+(\d+) cycles\s+\S+ s\s+(.*)$')
+
+def bench_name(image):
+    return os.path.splitext(os.path.basename(image))[0]
+
+def read_baseline(path):
+    baseline = {}
+    if os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                fields = line.split()
+                if fields and not fields[0].startswith('#'):
+                    baseline[fields[0]] = (int(fields[1]), int(fields[2]))
+    return baseline
+
+def write_baseline(path, results):
+    with open(path, 'w') as f:
+        f.write('# benchmark cycles instret\n')
+        for name in sorted(results):
+            f.write('%s %d %d\n' % (name, results[name][0], results[name][1]))
+
+def run_batch(args):
+    with tempfile.NamedTemporaryFile('w', suffix='.batch', delete=False) as f:
+        f.write(''.join(image + '\n' for image in args.images))
+        batch = f.name
+    try:
+        proc = subprocess.run([args.model, '+batch=' + batch, '+batch_threads=%d' % args.threads,
+                               '+max_cycles=%d' % args.max_cycles],
+                              stdout=subprocess.PIPE, universal_newlines=True)
+    finally:
+        os.unlink(batch)
+
+    status = {}
+    for line in proc.stdout.splitlines():
+        match = BATCH_LINE.match(line)
+        if match:
+            status[match.group(3)] = match.group(1)
+    return status
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark performance regression check on the pcore model')
+    parser.add_argument('images', nargs='+')
+    parser.add_argument('--model', default='ver_work/Vpcore_tb')
+    parser.add_argument('--baseline', default='bench/perf_baseline.txt')
+    parser.add_argument('--tolerance', type=float, default=1.0, help='allowed cycle increase in percent')
+    parser.add_argument('--threads', type=int, default=os.cpu_count() or 1)
+    parser.add_argument('--max-cycles', type=int, default=200000000)
+    parser.add_argument('--update', action='store_true', help='write the counts as the new baseline')
+    args = parser.parse_args()
+
+    # Without a baseline every benchmark would pass as 'no baseline'
+    if not args.update and not os.path.exists(args.baseline):
+        print('No baseline %s, create it with make perf-baseline on the reference RTL' % args.baseline)
+        return 1
+
+    status   = run_batch(args)
+    baseline = read_baseline(args.baseline)
+    results  = {}
+    failed   = []
+    totals   = [0, 0, 0, 0]        # cycles, instret, branches, mispredicts
+
+    print('%-16s %12s %12s %8s %6s %7s %7s  %s' % ('benchmark', 'cycles', 'baseline', 'change', 'CPI', 'mispred',
+                                                  'retmisp', 'status'))
+    for image in args.images:
+        name   = bench_name(image)
+        result = status.get(image, 'NOT RUN')
+        counts = None
+        mispred = '      -'
+        retmisp = '      -'
+        if result in ('PASS', 'DONE') and os.path.exists(image + '.uart.log'):
+            with open(image + '.uart.log', errors='replace') as f:
+                match = PERF_LINE.search(f.read())
+            if match:
+                counts = (int(match.group(1)), int(match.group(2)))
+                totals[0] += counts[0]
+                totals[1] += counts[1]
+                if match.group(3):
+                    totals[2] += int(match.group(3))
+                    totals[3] += int(match.group(4))
+                    mispred = '%6.2f%%' % (100.0 * int(match.group(4)) / max(int(match.group(3)), 1))
+                if match.group(5):
+                    retmisp = '%6.2f%%' % (100.0 * int(match.group(6)) / max(int(match.group(5)), 1))
+            else:
+                result = 'NO COUNTS'
+
+        if counts is None:
+            print('%-16s %12s %12s %8s %6s %7s %7s  %s' % (name, '-', '-', '-', '-', '-', '-', result))
+            failed.append(name)
+            continue
+
+        results[name] = counts
+        cycles, instret = counts
+        cpi = '%6.3f' % (cycles / max(instret, 1))
+        if name not in baseline:
+            print('%-16s %12d %12s %8s %s %s %s  no baseline' % (name, cycles, '-', '-', cpi, mispred, retmisp))
+            continue
+
+        base_cycles, base_instret = baseline[name]
+        change = 100.0 * (cycles - base_cycles) / max(base_cycles, 1)
+        note = 'ok'
+        if change > args.tolerance:
+            note = 'REGRESSION'
+            failed.append(name)
+        elif change < -args.tolerance:
+            note = 'improved'
+        if instret != base_instret:
+            note += ' (instret %+d, binary changed?)' % (instret - base_instret)
+        print('%-16s %12d %12d %+7.2f%% %s %s %s  %s' % (name, cycles, base_cycles, change, cpi, mispred, retmisp,
+                                                         note))
+
+    # Aggregate CPI and branch misprediction rate to compare predictor or
+    # cache configurations with a single figure
+    if len(results) > 1:
+        total_mispred = '%6.2f%%' % (100.0 * totals[3] / totals[2]) if totals[2] else '      -'
+        print('%-16s %12d %12s %8s %6.3f %s' % ('total', totals[0], '', '', totals[0] / max(totals[1], 1),
+                                                 total_mispred))
+
+    if args.update:
+        baseline.update(results)
+        write_baseline(args.baseline, baseline)
+        print('Baseline of %d benchmarks written to %s' % (len(results), args.baseline))
+        return 1 if len(results) != len(args.images) else 0
+
+    if failed:
+        print('Failed: ' + ' '.join(failed))
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
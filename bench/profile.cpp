@@ -0,0 +1,77 @@
+/*********************************************************************
+ * Filename :    profile.cpp
+ *
+ * Description:  PC sampling profiler. pcore_tb.sv passes the shadow
+ *               call stack and the last retired PC every prof_period
+ *               cycles, identical samples are counted in a histogram
+ *               that is written at the end of the simulation. Each
+ *               line holds the count, privilege mode, satp, sampled
+ *               PC and the call sites from the outermost one, all in
+ *               hex. bench/tools/prof_report.py maps them to functions
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+static const char                               *prof_path = NULL;
+static std::vector<uint32_t>                      prof_stack;
+static std::unordered_map<std::string, uint64_t>  prof_hist;
+static uint64_t                                   prof_samples = 0;
+
+int prof_enabled() {
+  const char *arg = Verilated::commandArgsPlusMatch("prof=");
+  if (!arg[0])
+    return 0;
+  prof_path = arg + 6;
+  return 1;
+}
+
+void prof_frame(int pc) {
+  prof_stack.push_back(pc);
+}
+
+void prof_sample(int pc, int priv, int satp) {
+  char key[32];
+  snprintf(key, sizeof(key), "%x %08x %08x", priv, (uint32_t)satp, (uint32_t)pc);
+
+  std::string sample(key);
+  for (uint32_t frame : prof_stack) {
+    snprintf(key, sizeof(key), " %08x", frame);
+    sample += key;
+  }
+  prof_stack.clear();
+
+  prof_hist[sample]++;
+  prof_samples++;
+}
+
+void prof_close() {
+  if (!prof_path)
+    return;
+
+  FILE *fp = fopen(prof_path, "w");
+  if (!fp) {
+    printf("Cannot create profile %s\n", prof_path);
+    return;
+  }
+
+  std::vector<std::pair<std::string, uint64_t>> samples(prof_hist.begin(), prof_hist.end());
+  std::sort(samples.begin(), samples.end(),
+            [](const std::pair<std::string, uint64_t> &a, const std::pair<std::string, uint64_t> &b) {
+              return a.second > b.second;
+            });
+  for (auto &sample : samples)
+    fprintf(fp, "%lu %s\n", (unsigned long)sample.second, sample.first.c_str());
+  fclose(fp);
+
+  printf("Profile: %lu samples written to %s\n", (unsigned long)prof_samples, prof_path);
+  prof_path = NULL;
+}
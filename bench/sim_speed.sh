@@ -0,0 +1,48 @@
+#!/bin/bash
+#*********************************************************************
+#  * Filename :    sim_speed.sh
+#  *
+#  * Description:  Builds the verilator model at 1/2/4/8 threads and
+#  *               reports the simulated kHz for the hello.hex run and
+#  *               for a fixed Linux boot window
+#  *
+#  * Usage:        bench/sim_speed.sh [thread counts...]
+#  *               imem_uart, imem_linux, uart_cycles and linux_cycles
+#  *               may be overridden from the environment
+#  *********************************************************************
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+thread_list=${@:-"1 2 4 8"}
+imem_uart=${imem_uart:-sdk/example-uart/build/hello.hex}
+imem_linux=${imem_linux:-sdk/example-linux/imem.txt}
+uart_cycles=${uart_cycles:-2000000}
+linux_cycles=${linux_cycles:-20000000}
+report=${report:-sim_speed.log}
+
+# Returns the kHz figure printed by the testbench at exit
+run_khz() {
+    "$@" | sed -n 's/.*(\([0-9.]*\) kHz).*/\1/p'
+}
+
+if [ ! -f "$imem_linux" ] && [ -f sdk/example-linux/imem.zip ]; then
+    unzip -o sdk/example-linux/imem.zip -d sdk/example-linux/ > /dev/null
+fi
+
+printf "%-8s %-16s %-16s\n" "threads" "hello.hex (kHz)" "linux (kHz)" | tee $report
+
+for t in $thread_list; do
+    lib=ver_work_t$t
+    make verilate threads=$t ver-library=$lib > $lib.build.log 2>&1
+
+    uart_khz=$(run_khz $lib/Vpcore_tb +imem=$imem_uart +max_cycles=$uart_cycles)
+
+    linux_khz="-"
+    if [ -f "$imem_linux" ]; then
+        linux_khz=$(run_khz $lib/Vpcore_tb +imem=$imem_linux +max_cycles=$linux_cycles)
+    fi
+
+    printf "%-8s %-16s %-16s\n" "$t" "$uart_khz" "$linux_khz" | tee -a $report
+done
@@ -0,0 +1,107 @@
+/*********************************************************************
+ * Filename :    sparse_mem.cpp
+ *
+ * Description:  Sparse main memory for simulation (SPARSE_MEM). The
+ *               word addressed memory of main_mem.sv is split into
+ *               4 KB pages that are allocated on first write, reads of
+ *               untouched pages return zero
+ *********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define MEM_ADDR_WIDTH   26                      // Byte address width of main_mem
+#define PAGE_WORDS_LOG2  10                      // 4 KB pages
+#define PAGE_WORDS       (1 << PAGE_WORDS_LOG2)
+#define PAGE_COUNT       (1 << (MEM_ADDR_WIDTH - 12))
+
+// Per thread, the batch mode runs one model on each thread
+static thread_local uint32_t *sparse_pages[PAGE_COUNT];
+static thread_local uint32_t  sparse_page_count = 0;
+
+static uint32_t *sparse_mem_page(uint32_t word_addr) {
+  uint32_t page = (word_addr >> PAGE_WORDS_LOG2) & (PAGE_COUNT - 1);
+  if (!sparse_pages[page]) {
+    sparse_pages[page] = new uint32_t[PAGE_WORDS]();
+    sparse_page_count++;
+  }
+  return sparse_pages[page];
+}
+
+int sparse_mem_read(int word_addr) {
+  uint32_t page = ((uint32_t)word_addr >> PAGE_WORDS_LOG2) & (PAGE_COUNT - 1);
+  if (!sparse_pages[page])
+    return 0;
+  return sparse_pages[page][word_addr & (PAGE_WORDS - 1)];
+}
+
+void sparse_mem_write(int word_addr, int data) {
+  sparse_mem_page(word_addr)[word_addr & (PAGE_WORDS - 1)] = data;
+}
+
+// $readmemh compatible loader, one hex word per line with optional
+// @address lines and // comments
+void sparse_mem_load_hex(const char *filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    printf("Warning: cannot open %s\n", filename);
+    return;
+  }
+
+  std::string token;
+  uint32_t word_addr = 0;
+  while (file >> token) {
+    if (token.compare(0, 2, "//") == 0) {
+      std::getline(file, token);
+    } else if (token[0] == '@') {
+      word_addr = strtoul(token.c_str() + 1, NULL, 16);
+    } else {
+      uint32_t data = strtoul(token.c_str(), NULL, 16);
+      // Zero words need no page
+      if (data || sparse_pages[(word_addr >> PAGE_WORDS_LOG2) & (PAGE_COUNT - 1)])
+        sparse_mem_write(word_addr, data);
+      word_addr++;
+    }
+  }
+}
+
+// DPI function called between the images of a batch, all pages are freed
+void sparse_mem_clear() {
+  for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+    delete[] sparse_pages[page];
+    sparse_pages[page] = NULL;
+  }
+  sparse_page_count = 0;
+}
+
+uint32_t sparse_mem_pages() {
+  return sparse_page_count;
+}
+
+#ifdef PCORE_SAVABLE
+// Allocated pages are saved as (page number, contents) pairs
+void sparse_mem_save(VerilatedSave &os) {
+  os << sparse_page_count;
+  for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+    if (sparse_pages[page]) {
+      os << page;
+      os.write(sparse_pages[page], PAGE_WORDS * sizeof(uint32_t));
+    }
+  }
+}
+
+void sparse_mem_restore(VerilatedRestore &os) {
+  uint32_t count;
+  os >> count;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t page;
+    os >> page;
+    os.read(sparse_mem_page(page << PAGE_WORDS_LOG2), PAGE_WORDS * sizeof(uint32_t));
+  }
+}
+#endif
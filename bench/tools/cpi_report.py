@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+#*********************************************************************
+#  * Filename :    cpi_report.py
+#  *
+#  * Description:  Groups the regions of a +cpi CPI stack by function
+#  *               using the symbol tables of one or more ELF files, or
+#  *               by address ranges of a given size, and prints the
+#  *               cycle breakdown of the ones with the most cycles
+#  *
+#  * Usage:        cpi_report.py pcore.cpi [--elf prog.elf] [--region BYTES]
+#  *                             [--top N]
+#  *********************************************************************
+
+import argparse
+import sys
+
+from prof_report import Symbolizer
+
+def main():
+    parser = argparse.ArgumentParser(description='Report a pcore +cpi CPI stack')
+    parser.add_argument('cpi')
+    parser.add_argument('--elf', action='append', default=[], help='ELF file with symbols, may be repeated')
+    parser.add_argument('--region', type=lambda x: int(x, 0), default=0, help='group by address ranges of this size')
+    parser.add_argument('--top', type=int, default=20, help='functions or regions printed')
+    args = parser.parse_args()
+
+    symbolizer = Symbolizer(args.elf) if args.elf else None
+    groups = {}
+    total = None
+
+    with open(args.cpi) as f:
+        names = f.readline().split()[2:]
+        for line in f:
+            fields = line.split()
+            region = int(fields[0], 16)
+            counts = [int(count) for count in fields[1:]]
+            if symbolizer:
+                key = symbolizer.lookup(region)
+            elif args.region:
+                key = '0x%08x' % (region - region % args.region)
+            else:
+                key = '0x%08x' % region
+            group = groups.setdefault(key, [0] * len(counts))
+            for i, count in enumerate(counts):
+                group[i] += count
+            total = counts if total is None else [a + b for a, b in zip(total, counts)]
+
+    if total is None:
+        sys.exit(args.cpi + ': no cycles')
+
+    print('%10s %6s %7s ' % ('cycles', '%', 'CPI') + ' '.join('%8s' % name for name in names[1:]) +
+          ('  function' if symbolizer else '  region'))
+    rows = sorted(groups.items(), key=lambda item: -sum(item[1]))[:args.top] + [('total', total)]
+    for key, counts in rows:
+        cycles = sum(counts)
+        share = ['%7.1f%%' % (100.0 * count / cycles) for count in counts[1:]]
+        print('%10d %5.1f%% %7.2f ' % (cycles, 100.0 * cycles / sum(total), cycles / max(counts[0], 1)) +
+              ' '.join('%8s' % s for s in share) + '  ' + key)
+
+if __name__ == '__main__':
+    main()
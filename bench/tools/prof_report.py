@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+#*********************************************************************
+#  * Filename :    prof_report.py
+#  *
+#  * Description:  Maps the samples of a +prof profile to functions using
+#  *               the symbol tables of one or more ELF files, and prints
+#  *               a flat profile or folded stacks for flamegraph.pl
+#  *
+#  * Usage:        prof_report.py pcore.prof --elf prog.elf [--elf vmlinux]
+#  *                              [--folded] [--priv M|S|U] [--top N]
+#  *********************************************************************
+
+import argparse
+import bisect
+import struct
+import sys
+
+PRIV_MODES = {'U': 0, 'S': 1, 'M': 3}
+
+def elf_symbols(path):
+    # Function symbols (STT_FUNC) of a 32-bit little-endian ELF file
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] != 1:
+        sys.exit(path + ': not a 32-bit ELF file')
+
+    shoff, = struct.unpack_from('<I', data, 0x20)
+    shentsize, shnum = struct.unpack_from('<HH', data, 0x2e)
+    sections = [struct.unpack_from('<IIIIIIIIII', data, shoff + i * shentsize) for i in range(shnum)]
+
+    symbols = []
+    for sh_name, sh_type, _, _, sh_offset, sh_size, sh_link, _, _, sh_entsize in sections:
+        if sh_type != 2:                                    # SHT_SYMTAB
+            continue
+        strtab = sections[sh_link]
+        for offset in range(sh_offset, sh_offset + sh_size, sh_entsize):
+            st_name, st_value, st_size, st_info, _, _ = struct.unpack_from('<IIIBBH', data, offset)
+            if (st_info & 0xf) != 2 or st_value == 0:       # STT_FUNC
+                continue
+            name_start = strtab[4] + st_name
+            name = data[name_start:data.index(b'\0', name_start)].decode()
+            symbols.append((st_value, st_size, name))
+    return symbols
+
+class Symbolizer:
+    def __init__(self, elfs):
+        symbols = sorted(sym for path in elfs for sym in elf_symbols(path))
+        self.addrs = [sym[0] for sym in symbols]
+        self.symbols = symbols
+        self.cache = {}
+
+    def lookup(self, pc):
+        if pc not in self.cache:
+            i = bisect.bisect_right(self.addrs, pc) - 1
+            name = '0x%08x' % pc
+            if i >= 0:
+                addr, size, sym = self.symbols[i]
+                if size == 0 or pc < addr + size:
+                    name = sym
+            self.cache[pc] = name
+        return self.cache[pc]
+
+def main():
+    parser = argparse.ArgumentParser(description='Symbolize a pcore +prof profile')
+    parser.add_argument('profile')
+    parser.add_argument('--elf', action='append', default=[], help='ELF file with symbols, may be repeated')
+    parser.add_argument('--folded', action='store_true', help='print folded stacks for flamegraph.pl')
+    parser.add_argument('--priv', choices=PRIV_MODES.keys(), help='only samples taken in this privilege mode')
+    parser.add_argument('--top', type=int, default=40, help='functions in the flat profile')
+    args = parser.parse_args()
+
+    symbolizer = Symbolizer(args.elf)
+    flat = {}
+    folded = {}
+    total = 0
+
+    with open(args.profile) as f:
+        for line in f:
+            fields = line.split()
+            count, priv = int(fields[0]), int(fields[1], 16)
+            if args.priv and priv != PRIV_MODES[args.priv]:
+                continue
+            pc = int(fields[3], 16)
+            stack = [int(frame, 16) for frame in fields[4:]]
+
+            func = symbolizer.lookup(pc)
+            flat[func] = flat.get(func, 0) + count
+            total += count
+            if args.folded:
+                key = ';'.join([symbolizer.lookup(frame) for frame in stack] + [func])
+                folded[key] = folded.get(key, 0) + count
+
+    if args.folded:
+        for key, count in sorted(folded.items(), key=lambda item: -item[1]):
+            print('%s %d' % (key, count))
+        return
+
+    print('%8s %7s  %s' % ('samples', '%', 'function'))
+    for func, count in sorted(flat.items(), key=lambda item: -item[1])[:args.top]:
+        print('%8d %6.2f%%  %s' % (count, 100.0 * count / max(total, 1), func))
+    print('%8d total samples' % total)
+
+if __name__ == '__main__':
+    main()
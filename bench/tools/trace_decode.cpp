@@ -0,0 +1,127 @@
+/*********************************************************************
+ * Filename :    trace_decode.cpp
+ *
+ * Description:  Prints a binary commit log written with +trace=<file>
+ *               in the commit log format of Spike (--log-commits),
+ *               so the two can be compared with diff. Build with
+ *               "make trace-decode", zstd=1 adds .zst input support
+ *
+ * Usage:        trace_decode [-c] <trace file | ->
+ *               -c prefixes each line with the retirement cycle
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "commit_log.h"
+
+#ifdef PCORE_ZSTD
+#include <zstd.h>
+#endif
+
+#define ZSTD_FRAME_MAGIC  0xFD2FB528u
+
+// Input stream, optionally zstd compressed
+static FILE          *in_fp;
+static bool           in_zstd = false;
+#ifdef PCORE_ZSTD
+static ZSTD_DCtx     *in_dctx;
+static char          *in_zbuf;
+static ZSTD_inBuffer  in_zin;
+#endif
+
+static size_t read_raw(void *dst, size_t len) {
+#ifdef PCORE_ZSTD
+  if (in_zstd) {
+    ZSTD_outBuffer out = { dst, len, 0 };
+    while (out.pos < out.size) {
+      if (in_zin.pos == in_zin.size) {
+        in_zin.size = fread(in_zbuf, 1, ZSTD_DStreamInSize(), in_fp);
+        in_zin.pos  = 0;
+        if (!in_zin.size)
+          break;
+      }
+      size_t ret = ZSTD_decompressStream(in_dctx, &out, &in_zin);
+      if (ZSTD_isError(ret)) {
+        fprintf(stderr, "zstd: %s\n", ZSTD_getErrorName(ret));
+        exit(EXIT_FAILURE);
+      }
+    }
+    return out.pos;
+  }
+#endif
+  return fread(dst, 1, len, in_fp);
+}
+
+static void print_rec(const commit_rec &rec, bool cycles) {
+  if (cycles)
+    printf("%10lu ", (unsigned long)rec.cycle);
+  commit_rec_print(stdout, rec);
+}
+
+int main(int argc, char **argv) {
+  bool        cycles = false;
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-c"))
+      cycles = true;
+    else
+      path = argv[i];
+  }
+  if (!path) {
+    fprintf(stderr, "Usage: %s [-c] <trace file | ->\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  in_fp = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+  if (!in_fp) {
+    fprintf(stderr, "Cannot open %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  // A zstd frame is recognised by its magic number
+  uint32_t magic;
+  if (fread(&magic, 1, sizeof(magic), in_fp) != sizeof(magic)) {
+    fprintf(stderr, "%s: empty trace\n", path);
+    return EXIT_FAILURE;
+  }
+  if (magic == ZSTD_FRAME_MAGIC) {
+#ifdef PCORE_ZSTD
+    in_zstd = true;
+    in_dctx = ZSTD_createDCtx();
+    in_zbuf = (char *)malloc(ZSTD_DStreamInSize());
+    memcpy(in_zbuf, &magic, sizeof(magic));
+    in_zin  = { in_zbuf, sizeof(magic), 0 };
+#else
+    fprintf(stderr, "%s: compressed trace, rebuild with zstd=1 or use zstd -dc\n", path);
+    return EXIT_FAILURE;
+#endif
+  }
+
+  commit_log_header hdr;
+  if (in_zstd) {
+    if (read_raw(&hdr, sizeof(hdr)) != sizeof(hdr))
+      hdr.magic = 0;
+  } else {
+    hdr.magic = magic;
+    if (fread((char *)&hdr + sizeof(magic), 1, sizeof(hdr) - sizeof(magic), in_fp) !=
+        sizeof(hdr) - sizeof(magic))
+      hdr.magic = 0;
+  }
+  if (hdr.magic != COMMIT_LOG_MAGIC || hdr.version != COMMIT_LOG_VERSION ||
+      hdr.rec_size != sizeof(commit_rec)) {
+    fprintf(stderr, "%s: not a commit log\n", path);
+    return EXIT_FAILURE;
+  }
+
+  commit_rec recs[4096];
+  size_t     len;
+  while ((len = read_raw(recs, sizeof(recs))) >= sizeof(commit_rec)) {
+    for (size_t i = 0; i < len / sizeof(commit_rec); i++)
+      print_rec(recs[i], cycles);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*********************************************************************
+ * Filename :    uart_log.cpp
+ *
+ * Description:  Host side of the UART, the transmitted bytes are
+ *               passed from pcore_tb.sv through DPI and appended to
+ *               uart_logdata.log. With the console enabled they are
+ *               also written to stdout and stdin is sent to the UART
+ *               receiver
+ *********************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <deque>
+#include <string>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#define UART_TAIL_SIZE    256
+#define UART_POLL_CYCLES  1000     // stdin is polled once every UART_POLL_CYCLES idle cycles
+
+// The log is kept per thread, the batch mode runs one model on each thread
+static thread_local const char  *uart_path = "uart_logdata.log";
+static thread_local FILE        *uart_fp   = NULL;
+static thread_local uint64_t     uart_pos  = 0;
+static thread_local std::string  uart_tail;
+
+static bool             uart_console = false;
+static int              uart_stdin_flags;
+static uint32_t         uart_poll_count = 0;
+static std::deque<char> uart_rx_queue;
+
+// The log is created on the first transmitted byte, a restored run
+// truncates the existing log to the checkpointed position instead
+static void uart_log_file() {
+  if (uart_fp)
+    return;
+
+  if (uart_pos) {
+    uart_fp = fopen(uart_path, "r+");
+    if (uart_fp && !ftruncate(fileno(uart_fp), uart_pos)) {
+      fseek(uart_fp, 0, SEEK_END);
+      return;
+    }
+    printf("Warning: %s does not match the checkpoint, starting a new log\n", uart_path);
+    if (uart_fp)
+      fclose(uart_fp);
+  }
+  uart_fp = fopen(uart_path, "w");
+}
+
+void uart_log_open(const char *path, uint64_t pos) {
+  if (uart_fp)
+    fclose(uart_fp);
+  uart_fp   = NULL;
+  uart_path = path;
+  uart_pos  = pos;
+  uart_tail.clear();
+}
+
+void uart_log_close() {
+  if (uart_fp)
+    fclose(uart_fp);
+  uart_fp = NULL;
+
+  if (uart_console)
+    fcntl(STDIN_FILENO, F_SETFL, uart_stdin_flags);
+}
+
+void uart_console_open() {
+  uart_console     = true;
+  uart_stdin_flags = fcntl(STDIN_FILENO, F_GETFL);
+  fcntl(STDIN_FILENO, F_SETFL, uart_stdin_flags | O_NONBLOCK);
+}
+
+uint64_t uart_log_pos() {
+  return uart_pos;
+}
+
+bool uart_log_ends_with(const char *str) {
+  size_t len = strlen(str);
+  return (uart_tail.size() >= len) &&
+         (uart_tail.compare(uart_tail.size() - len, len, str) == 0);
+}
+
+// DPI function called by pcore_tb.sv for every transmitted byte
+void uart_tx_byte(char data) {
+  uart_log_file();
+  if (uart_fp)
+    fputc(data, uart_fp);
+
+  if (uart_console) {
+    fputc(data, stdout);
+    fflush(stdout);
+  }
+
+  timeline_uart(data);
+
+  uart_pos++;
+  uart_tail.push_back(data);
+  if (uart_tail.size() > UART_TAIL_SIZE)
+    uart_tail.erase(0, uart_tail.size() - UART_TAIL_SIZE);
+}
+
+// DPI function called by pcore_tb.sv when the receiver can take a new
+// byte, returns -1 when no console input is available
+int uart_rx_byte() {
+  if (!uart_console)
+    return -1;
+
+  if (uart_rx_queue.empty() && (++uart_poll_count == UART_POLL_CYCLES)) {
+    char buf[256];
+    ssize_t len = read(STDIN_FILENO, buf, sizeof(buf));
+    uart_rx_queue.insert(uart_rx_queue.end(), buf, buf + (len > 0 ? len : 0));
+    uart_poll_count = 0;
+  }
+
+  if (uart_rx_queue.empty())
+    return -1;
+
+  int data = (uint8_t)uart_rx_queue.front();
+  uart_rx_queue.pop_front();
+  return data;
+}
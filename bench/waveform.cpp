@@ -0,0 +1,178 @@
+/*********************************************************************
+ * Filename :    waveform.cpp
+ *
+ * Description:  Waveform capture for the testbench. The dump can be
+ *               limited to a window of simulation time, armed and
+ *               disarmed by a retired PC or a UART string, and kept
+ *               in memory as a ring of the last cycles that is written
+ *               out at the end of the simulation. Models built with
+ *               trace_fst=1 write FST instead of VCD
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "pcore_tb.h"
+#include "Vpcore_tb.h"
+#include "Vpcore_tb__Dpi.h"
+
+#if VM_TRACE_FST
+#include "verilated_fst_c.h"
+typedef VerilatedFstC VerilatedTraceC;
+#define WAVE_FILE       "trace.fst"
+#define WAVE_FILE_PREV  "trace_prev.fst"
+#else
+#include "verilated_vcd_c.h"
+typedef VerilatedVcdC VerilatedTraceC;
+#define WAVE_FILE       "trace.vcd"
+#define WAVE_FILE_PREV  "trace_prev.vcd"
+#endif
+
+static VerilatedTraceC *tfp = NULL;
+
+#if !VM_TRACE_FST
+// Ring mode output of the VCD writer, every reopen starts a new segment
+// (header and full dump included) and keeps the previous one, so the two
+// segments together always cover the last wave_ring cycles
+class WaveRingFile : public VerilatedVcdFile {
+public:
+  std::string segment;
+  std::string segment_prev;
+
+  bool open(const std::string &name) override {
+    segment_prev.swap(segment);
+    segment.clear();
+    return true;
+  }
+  void close() override {}
+  ssize_t write(const char *bufp, ssize_t len) override {
+    segment.append(bufp, len);
+    return len;
+  }
+};
+
+static WaveRingFile *wave_ring_file = NULL;
+
+static void wave_ring_write(const char *filename, const std::string &segment) {
+  if (segment.empty())
+    return;
+  FILE *file = fopen(filename, "wb");
+  if (!file) {
+    printf("Warning: cannot open %s\n", filename);
+    return;
+  }
+  fwrite(segment.data(), 1, segment.size(), file);
+  fclose(file);
+}
+#endif
+
+static vluint64_t  wave_start = 0;          // Window in simulation time units
+static vluint64_t  wave_stop  = 0;
+static vluint64_t  wave_ring  = 0;          // Ring segment length in cycles, 0 when disabled
+static vluint64_t  wave_segment_start = 0;
+static bool        wave_armed = true;
+
+static std::string wave_uart_on;
+static std::string wave_uart_off;
+static uint64_t    wave_uart_pos = 0;
+
+static const char *wave_plusarg(const char *match) {
+  const char *arg = Verilated::commandArgsPlusMatch(match);
+  return arg[0] ? arg + strlen(match) + 1 : NULL;
+}
+
+void wave_close() {
+  if (tfp)
+    tfp->close();
+  tfp = NULL;
+
+#if !VM_TRACE_FST
+  if (wave_ring_file) {
+    wave_ring_write(WAVE_FILE_PREV, wave_ring_file->segment_prev);
+    wave_ring_write(WAVE_FILE, wave_ring_file->segment);
+    delete wave_ring_file;
+    wave_ring_file = NULL;
+  }
+#endif
+}
+
+void wave_open(Vpcore_tb *tb) {
+  const char *arg = wave_plusarg("vcd=");
+  if (!arg || !atoi(arg))
+    return;
+
+  if ((arg = wave_plusarg("vcd_start=")))
+    wave_start = strtoull(arg, NULL, 0);
+  if ((arg = wave_plusarg("vcd_stop=")))
+    wave_stop = strtoull(arg, NULL, 0);
+  if ((arg = wave_plusarg("vcd_ring=")))
+    wave_ring = strtoull(arg, NULL, 0);
+  if ((arg = wave_plusarg("vcd_uart_on=")))
+    wave_uart_on = arg;
+  if ((arg = wave_plusarg("vcd_uart_off=")))
+    wave_uart_off = arg;
+
+  // An arming trigger starts the dump disarmed, the PC triggers are
+  // evaluated at retirement by pcore_tb.sv
+  wave_armed = !wave_plusarg("vcd_pc_on=") && wave_uart_on.empty();
+
+  Verilated::traceEverOn(true);
+#if !VM_TRACE_FST
+  if (wave_ring) {
+    wave_ring_file = new WaveRingFile;
+    tfp = new VerilatedTraceC(wave_ring_file);
+  } else {
+    tfp = new VerilatedTraceC;
+  }
+#else
+  tfp = new VerilatedTraceC;
+#endif
+  tb->trace(tfp, 99);
+  tfp->open(WAVE_FILE);
+
+  // Keep the waveform readable if the simulation ends with a fatal error
+  atexit(wave_close);
+}
+
+// DPI function called by pcore_tb.sv when a PC trigger retires
+void wave_trigger(svBit on) {
+  wave_armed = on;
+}
+
+void wave_dump(vluint64_t time) {
+  if (!tfp)
+    return;
+
+  if (uart_log_pos() != wave_uart_pos) {
+    wave_uart_pos = uart_log_pos();
+    if (!wave_uart_on.empty() && uart_log_ends_with(wave_uart_on.c_str()))
+      wave_armed = true;
+    if (!wave_uart_off.empty() && uart_log_ends_with(wave_uart_off.c_str()))
+      wave_armed = false;
+  }
+
+  if (!wave_armed || (time <= wave_start) || (wave_stop && (time > wave_stop)))
+    return;
+
+  // In ring mode the dump alternates between two segments of wave_ring
+  // cycles each, the older one is dropped when the next segment starts.
+  // VCD segments are held in memory until wave_close(), FST segments are
+  // written to the two files as the simulation runs
+  if (wave_ring) {
+    if (!wave_segment_start) {
+      wave_segment_start = time;
+    } else if (time - wave_segment_start >= wave_ring * 10) {
+      tfp->close();
+#if VM_TRACE_FST
+      rename(WAVE_FILE, WAVE_FILE_PREV);
+#endif
+      tfp->open(WAVE_FILE);
+      wave_segment_start = time;
+    }
+  }
+
+  tfp->dump(time);
+}
+
@@ -37,13 +37,16 @@ module core_top (
     output type_lsu2dbus_s              lsu2dbus_o,                // Signal to data bus 
     input  wire type_dbus2lsu_s         dbus2lsu_i,
     output logic                        dcache_flush_o,
- //   output logic                        lsu_flush_o,
+    output logic                        lsu_flush_o,
 
    // Memory mapped timer interface
    input wire type_clint2csr_s          clint2csr_i,
 
    // IRQ interface
-   input wire type_pipe2csr_s           core2pipe_i
+   input wire type_pipe2csr_s           core2pipe_i,
+
+   // Hardware performance monitor events from the memory system
+   input wire type_mem2hpm_s            mem2hpm_i
 
  //  input wire type_debug_port_s         debug_port_i 
 );
@@ -53,6 +56,7 @@ type_if2mmu_s                           if2mmu;
 type_mmu2if_s                           mmu2if;
 type_lsu2mmu_s                          lsu2mmu;
 type_mmu2lsu_s                          mmu2lsu;
+type_mmu2hpm_s                          mmu2hpm;
 
 
 pipeline_top pipeline_top_module (
@@ -76,12 +80,16 @@ pipeline_top pipeline_top_module (
     .lsu2dbus_o          (lsu2dbus_o),       // Signal to data bus 
     .dbus2lsu_i          (dbus2lsu_i),
     .dcache_flush_o      (dcache_flush_o),
-    .lsu_flush_o         (),
+    .lsu_flush_o         (lsu_flush_o),
 
     .clint2csr_i         (clint2csr_i),
 
     // IRQ lines
-    .core2pipe_i         (core2pipe_i)
+    .core2pipe_i         (core2pipe_i),
+
+    // Performance monitor events
+    .mem2hpm_i           (mem2hpm_i),
+    .mmu2hpm_i           (mmu2hpm)
 
    // .debug_port_i        (debug_port_i)
 );
@@ -100,7 +108,9 @@ mmu mmu_module (
     .mmu2if_o                   (mmu2if),
 
     .dcache2mmu_i               (dcache2mmu_i),
-    .mmu2dcache_o               (mmu2dcache_o)
+    .mmu2dcache_o               (mmu2dcache_o),
+
+    .mmu2hpm_o                  (mmu2hpm)
 );
 
 endmodule : core_top
@@ -31,7 +31,10 @@ module mmu (
 
    // MMU <---> Data cache interface
     input wire type_dcache2mmu_s                     dcache2mmu_i,   
-    output type_mmu2dcache_s                         mmu2dcache_o       
+    output type_mmu2dcache_s                         mmu2dcache_o,
+
+    // Hardware performance monitor events
+    output type_mmu2hpm_s                            mmu2hpm_o
 
 );
 
@@ -206,6 +209,12 @@ ptw ptw_module (
 );
 
 
+//============================ Hardware performance monitor events ============================//
+// A TLB miss is counted once for every page table walk the PTW starts
+assign mmu2hpm_o.itlb_miss  = ptw2mmu.iwalk_start;
+assign mmu2hpm_o.dtlb_miss  = ptw2mmu.dwalk_start;
+assign mmu2hpm_o.ptw_active = ptw2mmu.ptw_active;
+
 assign mmu2lsu_o  = mmu2lsu;
 assign mmu2if_o   = mmu2if;
 assign mmu2dcache_o = mmu2dcache;
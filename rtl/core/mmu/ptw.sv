@@ -265,6 +265,8 @@ end
 // Update the outputs
 assign ptw2mmu.ptw_active   = (ptw_state_ff != PTW_IDLE); 
 assign ptw2mmu.iwalk_active = iwalk_active_ff;
+assign ptw2mmu.iwalk_start  = (ptw_state_ff == PTW_IDLE) & (ptw_state_next == PTW_PROCESS_PTE) & iwalk_active_next;
+assign ptw2mmu.dwalk_start  = (ptw_state_ff == PTW_IDLE) & (ptw_state_next == PTW_PROCESS_PTE) & ~iwalk_active_next;
 assign ptw2mmu.vaddr        = vaddr_ff;
 
 assign itlb_update_o = itlb_update;
@@ -0,0 +1,113 @@
+// Copyright 2023 University of Engineering and Technology Lahore.
+// Licensed under the Apache License, Version 2.0, see LICENSE file for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Description: Branch predictor for the fetch stage. A table of 2-bit saturating
+//              counters indexed by the PC XORed with the global branch history
+//              (gshare, or bimodal with BP_GHR_BITS of 0) predicts the direction
+//              of conditional branches, whose target is taken from the fetched
+//              instruction. A direct-mapped branch target buffer predicts the
+//              target of JALR other than returns, which use ras.sv. Both are
+//              read combinationally with the fetch PC and updated with the
+//              outcome of branches and JALR resolved in EXE.
+//
+
+
+`ifndef VERILATOR
+`include "../../defines/pcore_interface_defs.svh"
+`else
+`include "pcore_interface_defs.svh"
+`endif
+
+module branch_pred (
+
+    input   logic                               rst_n,             // reset
+    input   logic                               clk,               // clock
+
+    // Fetch <---> Predictor lookup interface
+    input   logic [`XLEN-1:0]                   if2bp_pc_i,        // PC of the fetched instruction
+    output  logic                               bp2if_taken_o,     // Branch predicted taken
+    output  logic [`BP_BHT_AWIDTH-1:0]          bp2if_bht_idx_o,   // Counter used for the prediction
+    output  logic                               bp2if_btb_hit_o,   // JALR target available
+    output  logic [`XLEN-1:0]                   bp2if_btb_target_o,
+
+    // EXE ---> Predictor update interface
+    input   logic                               bp_update_i,       // Branch or JALR resolved
+    input wire type_exe2if_fb_s                 exe2if_fb_i
+);
+
+localparam BTB_TAG_WIDTH = `XLEN - `BP_BTB_AWIDTH - 2;
+localparam GHR_MASK      = (1 << `BP_GHR_BITS) - 1;
+
+// Direction counters, 2'b00 strongly not-taken to 2'b11 strongly taken
+logic [1:0]                          bht_ff[`BP_BHT_ENTRIES];
+logic [`BP_BHT_AWIDTH-1:0]           ghr_ff, ghr_next;
+logic [`BP_BHT_AWIDTH-1:0]           bht_idx;
+logic [1:0]                          bht_update_cnt;
+
+// Branch target buffer
+logic                                btb_valid_ff[`BP_BTB_ENTRIES];
+logic [BTB_TAG_WIDTH-1:0]            btb_tag_ff[`BP_BTB_ENTRIES];
+logic [`XLEN-1:0]                    btb_target_ff[`BP_BTB_ENTRIES];
+logic [`BP_BTB_AWIDTH-1:0]           btb_idx, btb_update_idx;
+logic [BTB_TAG_WIDTH-1:0]            btb_tag, btb_update_tag;
+
+type_exe2if_fb_s                     exe2if_fb;
+
+assign exe2if_fb = exe2if_fb_i;
+
+//================================= Prediction lookup ==================================//
+
+assign bht_idx = if2bp_pc_i[`BP_BHT_AWIDTH+1:2] ^ ghr_ff;
+assign btb_idx = if2bp_pc_i[`BP_BTB_AWIDTH+1:2];
+assign btb_tag = if2bp_pc_i[`XLEN-1:`BP_BTB_AWIDTH+2];
+
+assign bp2if_taken_o      = bht_ff[bht_idx][1];
+assign bp2if_bht_idx_o    = bht_idx;
+assign bp2if_btb_hit_o    = btb_valid_ff[btb_idx] & (btb_tag_ff[btb_idx] == btb_tag);
+assign bp2if_btb_target_o = btb_target_ff[btb_idx];
+
+//================================= Predictor update ===================================//
+
+// The counter used for the prediction is trained, the global history is updated
+// with the conditional branches in the order they are resolved
+assign bht_update_cnt = bht_ff[exe2if_fb.bp_bht_idx];
+
+always_ff @(posedge clk) begin
+    if (~rst_n) begin
+        bht_ff <= '{default: 2'b01};
+        ghr_ff <= '0;
+    end else begin
+        ghr_ff <= ghr_next;
+        if (bp_update_i & ~exe2if_fb.bp_jump) begin
+            if (exe2if_fb.bp_taken & (bht_update_cnt != 2'b11)) begin
+                bht_ff[exe2if_fb.bp_bht_idx] <= bht_update_cnt + 1'b1;
+            end else if (~exe2if_fb.bp_taken & (bht_update_cnt != 2'b00)) begin
+                bht_ff[exe2if_fb.bp_bht_idx] <= bht_update_cnt - 1'b1;
+            end
+        end
+    end
+end
+
+always_comb begin
+    ghr_next = ghr_ff;
+
+    if (bp_update_i & ~exe2if_fb.bp_jump) begin
+        ghr_next = ((ghr_ff << 1) | exe2if_fb.bp_taken) & GHR_MASK;
+    end
+end
+
+assign btb_update_idx = exe2if_fb.bp_pc[`BP_BTB_AWIDTH+1:2];
+assign btb_update_tag = exe2if_fb.bp_pc[`XLEN-1:`BP_BTB_AWIDTH+2];
+
+always_ff @(posedge clk) begin
+    if (~rst_n) begin
+        btb_valid_ff <= '{default: '0};
+    end else if (bp_update_i & exe2if_fb.bp_jump & ~exe2if_fb.bp_ret) begin
+        btb_valid_ff[btb_update_idx]  <= 1'b1;
+        btb_tag_ff[btb_update_idx]    <= btb_update_tag;
+        btb_target_ff[btb_update_idx] <= exe2if_fb.pc_new;
+    end
+end
+
+endmodule : branch_pred
@@ -43,6 +43,10 @@ module csr (
 
     // CSR <---> Forward_stall interface
     input wire type_fwd2csr_s               fwd2csr_i,
+
+    // Hardware performance monitor events
+    input wire type_mem2hpm_s               mem2hpm_i,
+    input wire type_mmu2hpm_s               mmu2hpm_i,
     output type_csr2fwd_s                   csr2fwd_o,
 
     // CSR <---> Decode feedback interface
@@ -68,6 +72,8 @@ type_csr2id_fb_s                 csr2id_fb;
 type_csr2fwd_s                   csr2fwd;
 type_fwd2csr_s                   fwd2csr;
 type_clint2csr_s                 clint2csr;
+type_mem2hpm_s                   mem2hpm;
+type_mmu2hpm_s                   mmu2hpm;
 
 logic [`XLEN-1:0]                csr_rdata; 
 logic [`XLEN-1:0]                csr_wdata;
@@ -92,6 +98,12 @@ logic [`XLEN-1:0]                csr_minstreth_ff,  csr_minstreth_next;
 logic [`XLEN-1:0]                csr_mcounteren_ff,  csr_mcounteren_next;
 type_mcountinhibit_reg_s         csr_mcountinhibit_ff,  csr_mcountinhibit_next; 
 
+// Hardware performance monitor counters and their event selectors, only
+// mhpmcounter3 to mhpmcounter(HPM_LAST) are implemented
+localparam int unsigned          HPM_LAST = `HPM_COUNTERS + 2;
+logic [63:0]                     csr_mhpmcounter_ff[3:HPM_LAST], csr_mhpmcounter_next[3:HPM_LAST];
+type_hpm_event_e                 csr_mhpmevent_ff[3:HPM_LAST],   csr_mhpmevent_next[3:HPM_LAST];
+
 // Machine mode CSRs for trap setup
 type_status_reg_s                csr_mstatus_ff,  csr_mstatus_next;
 logic [`XLEN-1:0]                csr_medeleg_ff,  csr_medeleg_next;
@@ -124,6 +136,9 @@ logic                            csr_minstret_wr_flag;
 logic                            csr_minstreth_wr_flag;
 logic                            csr_mcounteren_wr_flag;
 logic                            csr_mcountinhibit_wr_flag;
+logic                            csr_mhpmcounter_wr_flag;
+logic                            csr_mhpmcounterh_wr_flag;
+logic                            csr_mhpmevent_wr_flag;
 
 // Machine mode CSR write update flags for trap setup and handling registers
 logic                            csr_mstatus_wr_flag;
@@ -226,8 +241,24 @@ logic                            csr_mcycleh_inc;
 logic                            csr_minstret_inc;
 logic                            csr_minstreth_inc;
 logic                            is_not_ebreak;
+logic [4:0]                      hpm_idx;
+logic                            hpm_mcounter_sel;
+logic                            ucounter_sel;
+logic                            hpm_ucounter_sel;
+logic                            hpm_event_sel;
+logic                            hpm_counter_en;
+logic [15:0]                     hpm_events;
 logic                            is_not_ecall;
 
+`ifdef VERILATOR
+// Idle cycles skipped by the testbench in wfi fast-forward mode, it is 
+// set for a single cycle by bench/pcore_tb.sv and is zero otherwise
+logic [63:0]                     sim_skip_cycles;
+logic [63:0]                     sim_mcycle_skip;
+
+assign sim_mcycle_skip = {csr_mcycleh_ff, csr_mcycle_ff} + sim_skip_cycles + 1'b1;
+`endif
+
 // Virtual address generation and icache flush related signals
 logic                            satp_mode;
 logic                            csr_vaddr_iflush_req;
@@ -242,6 +273,8 @@ assign lsu2csr_ctrl = lsu2csr_ctrl_i;
 assign pipe2csr     = pipe2csr_i;
 assign fwd2csr      = fwd2csr_i;
 assign clint2csr    = clint2csr_i;
+assign mem2hpm      = mem2hpm_i;
+assign mmu2hpm      = mmu2hpm_i;
 
 // Load store related signals and faults
 assign ld_st_addr = lsu2csr_data.dbus_addr;
@@ -256,6 +289,22 @@ assign ld_misalign_exc_req = ((ld_ops == LD_OPS_LW)  && (|ld_st_addr[1:0]))
 assign st_misalign_exc_req = ((st_ops == ST_OPS_SW)  && (|ld_st_addr[1:0])) 
                            | ((st_ops == ST_OPS_SH)  && (ld_st_addr[0]));
 
+
+// Hardware performance monitor CSR decoding, mhpmcounter3..31(h) at 0xB03-0xB1F (0xB83-0xB9F),
+// their user mode shadows at 0xC03-0xC1F (0xC83-0xC9F) and mhpmevent3..31 at 0x323-0x33F
+assign hpm_idx          = exe2csr_data.csr_addr[4:0];
+assign hpm_mcounter_sel = (exe2csr_data.csr_addr[11:8] == 4'hB) & (exe2csr_data.csr_addr[6:5] == 2'b00)
+                        & (hpm_idx >= 5'd3);
+assign ucounter_sel     = (exe2csr_data.csr_addr[11:8] == 4'hC) & (exe2csr_data.csr_addr[6:5] == 2'b00);
+assign hpm_ucounter_sel = ucounter_sel & (hpm_idx >= 5'd3);
+assign hpm_event_sel    = (exe2csr_data.csr_addr[11:5] == 7'b0011001) & (hpm_idx >= 5'd3);
+
+// The user mode shadows (cycle, time, instret and hpmcounter3..31) are accessible in
+// S-mode when enabled by mcounteren and in U-mode when enabled by both mcounteren and
+// scounteren
+assign hpm_counter_en   = (priv_mode_ff == PRIV_MODE_M) 
+                        | (csr_mcounteren_ff[hpm_idx] & ((priv_mode_ff == PRIV_MODE_S) | csr_scounteren_ff[hpm_idx]));
+
                     
 //================================== CSR read operations ==================================//
 
@@ -285,9 +334,7 @@ always_comb begin
             CSR_ADDR_INSTRETH       : csr_rdata    = csr_minstreth_ff;
             CSR_ADDR_MCOUNTEREN     : csr_rdata    = csr_mcounteren_ff;
             CSR_ADDR_MCOUNTINHIBIT  : csr_rdata    = csr_mcountinhibit_ff;
-            
-        //    CSR_ADDR_MHPMCOUNTER3,
-        //    CSR_ADDR_MHPMCOUNTER3H  : csr_rdata    = '0;                    // Not implemented
+            // Hardware performance monitor counters and events are decoded in the default case
 
             // Read machine mode trap setup registers
             CSR_ADDR_MSTATUS        : csr_rdata    = csr_mstatus_ff;
@@ -331,8 +378,25 @@ always_comb begin
             default                 : begin
               //  csr_rd_exc_req  = exe2csr_ctrl.csr_rd_req;
                                       csr_rdata    = '0;           
+
+                // Counters that are not implemented read as zero
+                for (int unsigned i = 3; i <= HPM_LAST; i++) begin
+                    if (hpm_idx == i) begin
+                        if (hpm_event_sel) begin
+                            csr_rdata = `XLEN'(csr_mhpmevent_ff[i]);
+                        end else if (hpm_mcounter_sel | hpm_ucounter_sel) begin
+                            csr_rdata = exe2csr_data.csr_addr[7] ? csr_mhpmcounter_ff[i][63:32]
+                                                                 : csr_mhpmcounter_ff[i][31:0];
+                        end
+                    end
+                end
             end
         endcase // exu2csr_data.csr_addr
+
+        if (ucounter_sel & ~hpm_counter_en) begin
+            csr_rd_exc_req = 1'b1;
+            csr_rdata      = '0;
+        end
     end
 end
 
@@ -348,7 +412,9 @@ always_comb begin
     csr_minstreth_wr_flag      = 1'b0;
     csr_mcounteren_wr_flag     = 1'b0;
     csr_mcountinhibit_wr_flag  = 1'b0;
-
+    csr_mhpmcounter_wr_flag    = 1'b0;
+    csr_mhpmcounterh_wr_flag   = 1'b0;
+    csr_mhpmevent_wr_flag      = 1'b0;
 
     csr_mstatus_wr_flag        = 1'b0;
     csr_medeleg_wr_flag        = 1'b0;
@@ -382,9 +448,7 @@ always_comb begin
             CSR_ADDR_MINSTRETH      : csr_minstreth_wr_flag      = 1'b1;
             CSR_ADDR_MCOUNTEREN     : csr_mcounteren_wr_flag     = 1'b1;
             CSR_ADDR_MCOUNTINHIBIT  : csr_mcountinhibit_wr_flag  = 1'b1;
-
-        //    CSR_ADDR_MHPMCOUNTER3,
-        //    CSR_ADDR_MHPMCOUNTER3H  : begin end                       // Not implemented
+            // Hardware performance monitor counters and events are decoded in the default case
 
             // Machine mode flags for trap setup and handling registers write operation
             CSR_ADDR_MSTATUS        : csr_mstatus_wr_flag  = 1'b1;
@@ -421,6 +485,9 @@ always_comb begin
           */
             default                 : begin
               //  csr_wr_exc_req  = 1'b1;             
+                csr_mhpmcounter_wr_flag  = hpm_mcounter_sel & ~exe2csr_data.csr_addr[7];
+                csr_mhpmcounterh_wr_flag = hpm_mcounter_sel &  exe2csr_data.csr_addr[7];
+                csr_mhpmevent_wr_flag    = hpm_event_sel;
             end
         endcase // exu2csr_data.csr_addr
     end // exe2csr_ctrl.csr_wr_req
@@ -497,7 +564,11 @@ always_comb begin
     if (csr_mcycle_wr_flag) begin
         csr_mcycle_next = csr_wdata; 
     end else if (csr_mcycle_inc) begin                         
+`ifdef VERILATOR
+        csr_mcycle_next = sim_mcycle_skip[31:0];
+`else
         csr_mcycle_next = csr_mcycle_ff + 1'b1; 
+`endif
     end else begin
         csr_mcycle_next = csr_mcycle_ff;
     end    
@@ -525,6 +596,11 @@ always_comb begin
     end else begin
         csr_mcycleh_next = csr_mcycleh_ff;
     end      
+`ifdef VERILATOR
+    if (~csr_mcycleh_wr_flag & csr_mcycle_inc & (|sim_skip_cycles)) begin
+        csr_mcycleh_next = sim_mcycle_skip[63:32];
+    end
+`endif
 end
 
 // Update the minstret (machine instruction retire counter) CSR 
@@ -617,6 +693,79 @@ always_comb begin
     end      
 end
 
+// Update the mhpmcounter3..31 (machine performance monitor counter) CSRs
+// -----------------------------------------------------------------------
+assign hpm_events = {2'b0,
+                     fwd2csr.ret_flush,
+                     fwd2csr.ret_resolve,
+                     fwd2csr.bp_resolve,
+                     fwd2csr.div_stall,
+                     fwd2csr.lsu_stall,
+                     fwd2csr.ld_use_stall,
+                     fwd2csr.exe_flush,
+                     mmu2hpm.ptw_active,
+                     mmu2hpm.dtlb_miss,
+                     mmu2hpm.itlb_miss,
+                     mem2hpm.dcache_wrb,
+                     mem2hpm.dcache_miss,
+                     mem2hpm.icache_miss,
+                     1'b0};                                     // HPM_EVENT_NONE
+
+always_ff @(negedge rst_n, posedge clk) begin
+    if (~rst_n) begin
+        for (int unsigned i = 3; i <= HPM_LAST; i++) begin
+            csr_mhpmcounter_ff[i] <= '0;
+        end
+    end else begin
+        csr_mhpmcounter_ff <= csr_mhpmcounter_next;
+    end
+end
+
+always_comb begin 
+    for (int unsigned i = 3; i <= HPM_LAST; i++) begin
+        csr_mhpmcounter_next[i] = csr_mhpmcounter_ff[i];
+
+        if (~csr_mcountinhibit_ff[i] & hpm_events[csr_mhpmevent_ff[i]]) begin
+            csr_mhpmcounter_next[i] = csr_mhpmcounter_ff[i] + 1'b1;
+        end
+
+        // A write replaces its half of the counter in place of the increment
+        if (hpm_idx == i) begin
+            if (csr_mhpmcounter_wr_flag) begin
+                csr_mhpmcounter_next[i][31:0]  = csr_wdata;
+            end
+            if (csr_mhpmcounterh_wr_flag) begin
+                csr_mhpmcounter_next[i][63:32] = csr_wdata;
+            end
+        end
+    end
+end
+
+// Update the mhpmevent3..31 (machine performance monitor event selector) CSRs
+// ---------------------------------------------------------------------------
+always_ff @(negedge rst_n, posedge clk) begin
+    if (~rst_n) begin
+        for (int unsigned i = 3; i <= HPM_LAST; i++) begin
+            csr_mhpmevent_ff[i] <= HPM_EVENT_NONE;
+        end
+    end else begin
+        csr_mhpmevent_ff <= csr_mhpmevent_next;
+    end
+end
+
+always_comb begin 
+    for (int unsigned i = 3; i <= HPM_LAST; i++) begin
+        csr_mhpmevent_next[i] = csr_mhpmevent_ff[i];
+
+        // WARL, unsupported events select none
+        if (csr_mhpmevent_wr_flag && (hpm_idx == i)) begin
+            csr_mhpmevent_next[i] = (csr_wdata <= `XLEN'(HPM_EVENT_RET_FLUSH))
+                                  ? type_hpm_event_e'(csr_wdata[HPM_EVENT_WIDTH-1:0])
+                                  : HPM_EVENT_NONE;
+        end
+    end
+end
+
 //================================ Updating trap setup CSRs ================================//
 
 // Update mstatus/sstatus (machine/supervisor status) CSR and privilege mode
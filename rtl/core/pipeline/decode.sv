@@ -121,6 +121,7 @@ always_comb begin
     id2exe_data.instr    = instr_codeword;
     id2exe_data.pc       = if2id_data.pc;
     id2exe_data.pc_next  = if2id_data.pc_next;
+    id2exe_data.bp_pred  = if2id_data.bp_pred;
     id2exe_data.exc_code = EXC_CODE_NO_EXCEPTION;
     id2exe_data.instr_flushed = if2id_data.instr_flushed;
     
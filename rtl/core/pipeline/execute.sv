@@ -89,6 +89,9 @@ logic                                cmp_not_zero;
 logic                                cmp_neg;
 logic                                cmp_overflow;
 logic                                branch_res;
+logic                                branch_taken;
+logic                                branch_mispredict;
+logic  [`XLEN-1:0]                   branch_target;
 logic                                fence_i_req;
 
 logic  [4:0]                         shift_amt;
@@ -199,6 +202,14 @@ always_comb begin
    endcase
 end
 
+// Resolve the branch or JALR against the prediction made in fetch, a wrong direction
+// or JALR target redirects fetch. The fall-through PC is the pc_next of the instruction
+assign branch_taken      = id2exe_ctrl.jump_req | (id2exe_ctrl.branch_req & branch_res);
+assign branch_target     = {alu_result[31:2], 2'b0};
+assign branch_mispredict = (id2exe_ctrl.jump_req | id2exe_ctrl.branch_req)
+                         & ((branch_taken != id2exe_data.bp_pred.taken)
+                         | (branch_taken & (branch_target != id2exe_data.bp_pred.target)));
+
 //=================================== MUX for ALU output result =====================================//
  
 always_comb begin
@@ -527,7 +538,9 @@ assign exe2csr_data.csr_wdata = (id2exe_ctrl.csr_opr_sel == CSR_OPR_REG)
 // Signals from EXE module for forwarding evaluation
 assign exe2fwd.rs1_addr   = rs1_addr;
 assign exe2fwd.rs2_addr   = rs2_addr;
-assign exe2fwd.new_pc_req = id2exe_ctrl.jump_req || (id2exe_ctrl.branch_req & branch_res); // fence_i_req ||
+assign exe2fwd.new_pc_req = branch_mispredict; // fence_i_req ||
+assign exe2fwd.bp_resolve = id2exe_ctrl.jump_req | id2exe_ctrl.branch_req;
+assign exe2fwd.bp_ret     = id2exe_data.bp_pred.ras_pop;
 
 // The following signals determine whether the two operands are general-purpose registers
 // or not. These are used to minimize the number of stalls in case of load-use RAW hazards
@@ -547,7 +560,14 @@ assign exe2fwd_o       = exe2fwd;
 assign exe2div_o       = exe2div;
 
 // Update the feedback signals from EXE to IF stage                         
-assign exe2if_fb.pc_new       = {alu_result[31:2], 2'b0};  // fence_i_req ? id2exe_data.pc_next :  
+assign exe2if_fb.pc_new       = branch_taken ? branch_target : id2exe_data.pc_next;  // fence_i_req ? id2exe_data.pc_next :  
+assign exe2if_fb.bp_pc        = id2exe_data.pc;
+assign exe2if_fb.bp_bht_idx   = id2exe_data.bp_pred.bht_idx;
+assign exe2if_fb.bp_taken     = branch_taken;
+assign exe2if_fb.bp_jump      = id2exe_ctrl.jump_req;
+assign exe2if_fb.bp_ret       = id2exe_data.bp_pred.ras_pop;
+assign exe2if_fb.ras_ptr      = id2exe_data.bp_pred.ras_ptr;
+assign exe2if_fb.ras_valid    = ~id2exe_data.instr_flushed;
 // assign exe2if_fb.icache_flush = fence_i_req;                         
 assign exe2if_fb_o            = exe2if_fb;                  
 
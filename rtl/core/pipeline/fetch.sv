@@ -115,6 +115,9 @@ always_comb begin
         is_jal                : begin  // MT JAL
             pc_next = pc_ff + jal_imm; // pc_new_jal;
         end
+        bp_pred.taken         : begin
+            pc_next = bp_pred.target;
+        end
         default                 : begin       end
     endcase
 end
@@ -131,6 +134,76 @@ assign is_jal = if2id_data.instr[6:2] == OPCODE_JAL_INST;
 
 ////////////////////////////////////////////////////////////////
 
+// Branch prediction, conditional branches take the predicted direction with the
+// target from the instruction, returns the target from the return address stack
+// and other JALR the target from the BTB. The prediction is resolved in EXE, which
+// redirects fetch when the next PC differs from it
+type_bp_pred_s                       bp_pred;
+logic [`XLEN-1:0]                    branch_imm;
+logic                                is_branch, is_jalr;
+logic                                rd_link, rs1_link;
+logic                                if_accept;
+
+assign branch_imm = {{20{instr_word[31]}}, instr_word[7], instr_word[30:25], instr_word[11:8], 1'b0};
+assign is_branch  = if2id_data.instr[6:2] == OPCODE_BRANCH_INST;
+assign is_jalr    = if2id_data.instr[6:2] == OPCODE_JALR_INST;
+
+// Link registers ra and t0 mark calls and returns (RISC-V return address stack hints)
+assign rd_link    = (instr_word[11:7] == 5'd1) | (instr_word[11:7] == 5'd5);
+assign rs1_link   = (instr_word[19:15] == 5'd1) | (instr_word[19:15] == 5'd5);
+
+// The fetched instruction moves on to ID in this cycle
+assign if_accept  = ~(fwd2if.csr_new_pc_req | fwd2if.wfi_req | fwd2if.exe_new_pc_req | if_stall);
+
+`ifdef BRANCH_PREDICT
+logic                                bp_bht_taken;
+logic                                bp_btb_hit;
+logic [`XLEN-1:0]                    bp_btb_target;
+logic                                ras_push, ras_pop;
+logic [`XLEN-1:0]                    ras_top;
+
+branch_pred branch_pred_module (
+    .rst_n                      (rst_n),
+    .clk                        (clk),
+
+    .if2bp_pc_i                 (pc_ff),
+    .bp2if_taken_o              (bp_bht_taken),
+    .bp2if_bht_idx_o            (bp_pred.bht_idx),
+    .bp2if_btb_hit_o            (bp_btb_hit),
+    .bp2if_btb_target_o         (bp_btb_target),
+
+    .bp_update_i                (fwd2if.bp_update),
+    .exe2if_fb_i                (exe2if_fb)
+);
+
+// A JALR with different link registers as rd and rs1 pops and then pushes
+assign ras_push = if_accept & (is_jal | is_jalr) & rd_link;
+assign ras_pop  = if_accept & is_jalr & rs1_link & ~(rd_link & (instr_word[11:7] == instr_word[19:15]));
+
+ras ras_module (
+    .rst_n                      (rst_n),
+    .clk                        (clk),
+
+    .if2ras_push_i              (ras_push),
+    .if2ras_pop_i               (ras_pop),
+    .if2ras_addr_i              (pc_plus_4),
+    .ras2if_top_o               (ras_top),
+    .ras2if_ptr_o               (bp_pred.ras_ptr),
+
+    .exe2ras_restore_i          (fwd2if.exe_new_pc_req),
+    .exe2ras_commit_i           (fwd2if.exe_commit & exe2if_fb.ras_valid),
+    .exe2ras_ptr_i              (exe2if_fb.ras_ptr),
+    .csr2ras_restore_i          (fwd2if.csr_new_pc_req | fwd2if.wfi_req)
+);
+
+assign bp_pred.ras_pop = ras_pop;
+assign bp_pred.taken   = (is_branch & bp_bht_taken) | (is_jalr & (ras_pop | bp_btb_hit));
+assign bp_pred.target  = ras_pop ? ras_top : is_jalr ? bp_btb_target : (pc_ff + branch_imm);
+`else
+assign bp_pred = '0;
+`endif // BRANCH_PREDICT
+
+
 
 // Instruction fetch related exceptions including address misaligned, instruction page fault 
 // as well as instruction access fault
@@ -203,7 +276,8 @@ assign if2icache_o.icache_flush = csr2if_fb.icache_flush;
 // Update the outputs to ID stage
 assign if2id_data.instr         = instr_word;
 assign if2id_data.pc            = pc_ff;
-assign if2id_data.pc_next       = is_jal ? (pc_plus_4) : pc_next;
+assign if2id_data.pc_next       = (is_jal | bp_pred.taken) ? (pc_plus_4) : pc_next;
+assign if2id_data.bp_pred       = bp_pred;
 assign if2id_data.instr_flushed = 1'b0;
 
 assign if2id_data.exc_code      = exc_code_next;
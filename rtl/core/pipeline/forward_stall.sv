@@ -73,6 +73,8 @@ logic                                lsu_div_stall_ff;
 
 logic                                id_exe_flush;
 logic                                exe_new_pc_req;
+logic                                bp_update;
+logic                                exe_commit;
 
 //logic                                if2fwd_stall;
 
@@ -123,6 +125,11 @@ assign ld_use_hazard     = (ld_use_rs1_hazard | ld_use_rs2_hazard) & ~lsu_div_st
 // a stall from LSU stage   
 assign exe_new_pc_req = exe2fwd.new_pc_req & ~(ld_use_hazard | lsu_div_stall);  
 
+// The branch predictor is updated under the same condition, once per resolved branch 
+// or JALR that moves on to LSU without being killed by a CSR redirect
+assign exe_commit     = ~(ld_use_hazard | lsu_div_stall) & ~(csr2fwd.new_pc_req | csr2fwd.wfi_req);
+assign bp_update      = exe2fwd.bp_resolve & exe_commit;
+
 // Pipeline flush signals for different pipeline stages/modules 
 assign id_exe_flush                = exe_new_pc_req | csr2fwd.new_pc_req | csr2fwd.wfi_req;
 assign lsu_flush                   = csr2fwd.new_pc_req | csr2fwd.wfi_req;   
@@ -146,11 +153,22 @@ assign fwd2ptop.pipe_fwd_wrb_rs2   = fwd2exe.fwd_wrb_rs2;
 
 assign fwd2csr.pipe_stall          = lsu_div_stall_ff;
 
+// Events for the hardware performance monitor counters
+assign fwd2csr.exe_flush           = exe_new_pc_req & ~csr2fwd.new_pc_req;
+assign fwd2csr.bp_resolve          = bp_update;
+assign fwd2csr.ret_resolve         = bp_update & exe2fwd.bp_ret;
+assign fwd2csr.ret_flush           = fwd2csr.exe_flush & exe2fwd.bp_ret;
+assign fwd2csr.ld_use_stall        = ld_use_hazard;
+assign fwd2csr.lsu_stall           = lsu_stall_next;
+assign fwd2csr.div_stall           = div_stall_next;
+
 // Generate different PC update or stall signals for IF stage
 assign fwd2if.exe_new_pc_req = exe_new_pc_req & (~csr2fwd.new_pc_req);
 assign fwd2if.csr_new_pc_req = csr2fwd.new_pc_req;
 assign fwd2if.wfi_req        = csr2fwd.wfi_req;
 assign fwd2if.if_stall       = if_id_exe_stall;
+assign fwd2if.bp_update      = bp_update;
+assign fwd2if.exe_commit     = exe_commit;
 
 // LSU related stall signal using the 'ack' from lsu module
 always_ff @(posedge clk) begin
@@ -53,7 +53,11 @@ module pipeline_top (
    input wire type_clint2csr_s          clint2csr_i,
 
    // IRQ interface
-   input wire type_pipe2csr_s           core2pipe_i
+   input wire type_pipe2csr_s           core2pipe_i,
+
+   // Hardware performance monitor events
+   input wire type_mem2hpm_s            mem2hpm_i,
+   input wire type_mmu2hpm_s            mmu2hpm_i
 
  //  input wire type_debug_port_s         debug_port_i 
 );
@@ -176,6 +180,7 @@ always_ff @(posedge clk) begin
         if2id_data_pipe_ff.instr   <= 32'h00000013;
         if2id_data_pipe_ff.pc      <= '0;
         if2id_data_pipe_ff.pc_next <= '0;
+        if2id_data_pipe_ff.bp_pred <= '0;
         if2id_data_pipe_ff.instr_flushed <= 1'b0;
         if2id_data_pipe_ff.exc_code <= EXC_CODE_NO_EXCEPTION;
 
@@ -430,6 +435,8 @@ csr csr_module (
     .clint2csr_i                (clint2csr_i),
 
     .pipe2csr_i                 (core2pipe_i),
+    .mem2hpm_i                  (mem2hpm_i),
+    .mmu2hpm_i                  (mmu2hpm_i),
     .fwd2csr_i                  (fwd2csr),
     .csr2fwd_o                  (csr2fwd),
     .csr2id_fb_o                (csr2id_fb),
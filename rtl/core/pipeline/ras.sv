@@ -0,0 +1,78 @@
+// Copyright 2023 University of Engineering and Technology Lahore.
+// Licensed under the Apache License, Version 2.0, see LICENSE file for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Description: Return address stack for the fetch stage. Calls (JAL/JALR with a
+//              link register as rd) push the return address and returns (JALR
+//              with a link register as rs1) pop the predicted target. Every
+//              fetched instruction carries the stack pointer after its own push
+//              or pop, which restores the pointer when EXE redirects fetch. The
+//              pointer of the last instruction that left EXE restores it when
+//              the CSR unit redirects fetch on a trap or return from trap.
+//
+
+
+`ifndef VERILATOR
+`include "../../defines/pcore_interface_defs.svh"
+`else
+`include "pcore_interface_defs.svh"
+`endif
+
+module ras (
+
+    input   logic                               rst_n,             // reset
+    input   logic                               clk,               // clock
+
+    // Fetch <---> RAS interface
+    input   logic                               if2ras_push_i,     // Accepted call
+    input   logic                               if2ras_pop_i,      // Accepted return
+    input   logic [`XLEN-1:0]                   if2ras_addr_i,     // Return address of the call
+    output  logic [`XLEN-1:0]                   ras2if_top_o,      // Predicted return address
+    output  logic [`BP_RAS_AWIDTH-1:0]          ras2if_ptr_o,      // Pointer after the push or pop
+
+    // Pipeline ---> RAS repair interface
+    input   logic                               exe2ras_restore_i, // Redirect from EXE
+    input   logic                               exe2ras_commit_i,  // Instruction left EXE
+    input   logic [`BP_RAS_AWIDTH-1:0]          exe2ras_ptr_i,     // Pointer carried by the EXE instruction
+    input   logic                               csr2ras_restore_i  // Redirect from CSR
+);
+
+// The pointer addresses the next free entry and wraps around on overflow
+logic [`XLEN-1:0]                    ras_stack_ff[`BP_RAS_ENTRIES];
+logic [`BP_RAS_AWIDTH-1:0]           ras_ptr_ff, ras_ptr_next;
+logic [`BP_RAS_AWIDTH-1:0]           ras_ptr_pop;
+logic [`BP_RAS_AWIDTH-1:0]           ras_commit_ptr_ff;
+
+assign ras_ptr_pop  = if2ras_pop_i ? (ras_ptr_ff - 1'b1) : ras_ptr_ff;
+assign ras2if_top_o = ras_stack_ff[ras_ptr_ff - 1'b1];
+assign ras2if_ptr_o = if2ras_push_i ? (ras_ptr_pop + 1'b1) : ras_ptr_pop;
+
+always_comb begin
+    ras_ptr_next = ras2if_ptr_o;
+
+    if (csr2ras_restore_i) begin
+        ras_ptr_next = ras_commit_ptr_ff;
+    end else if (exe2ras_restore_i) begin
+        ras_ptr_next = exe2ras_ptr_i;
+    end
+end
+
+always_ff @(posedge clk) begin
+    if (~rst_n) begin
+        ras_ptr_ff        <= '0;
+        ras_commit_ptr_ff <= '0;
+    end else begin
+        ras_ptr_ff <= ras_ptr_next;
+        if (exe2ras_commit_i) begin
+            ras_commit_ptr_ff <= exe2ras_ptr_i;
+        end
+    end
+end
+
+always_ff @(posedge clk) begin
+    if (if2ras_push_i & ~(csr2ras_restore_i | exe2ras_restore_i)) begin
+        ras_stack_ff[ras_ptr_pop] <= if2ras_addr_i;
+    end
+end
+
+endmodule : ras
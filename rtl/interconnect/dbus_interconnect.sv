@@ -23,6 +23,7 @@ module dbus_interconnect (
     input wire type_lsu2dbus_s                     lsu2dbus_i,
     output type_dbus2lsu_s                         dbus2lsu_o,               // Signals to core
     input wire                                     dcache_flush_i,
+    input wire                                     sbuf_empty_i,             // Data memory stores have drained
 
     // dbus <----> Peripheral module interface
     input wire type_peri2dbus_s                    dcache2dbus_i,            // Signals from DATA memory 
@@ -58,6 +59,7 @@ logic                                 clint_addr_match;
 logic                                 plic_addr_match;
 logic                                 bmem_addr_match;
 logic                                 spi_addr_match;
+logic                                 sim_ctrl_addr_match;
 
 logic                                 dmem_sel;
 logic                                 uart_sel;
@@ -65,6 +67,8 @@ logic                                 clint_sel;
 logic                                 plic_sel;
 logic                                 bmem_sel;
 logic                                 spi_sel;
+logic                                 sim_ctrl_sel;
+logic                                 sim_ctrl_ack_ff;
 
 // Assign input signals
 assign lsu2dbus = lsu2dbus_i;
@@ -84,6 +88,13 @@ assign plic_addr_match  = (dbus_addr[`PERI_SEL_ADDR_HIGH:`PERI_SEL_ADDR_LOW] ==
 assign clint_addr_match = (dbus_addr[`PERI_SEL_ADDR_HIGH:`PERI_SEL_ADDR_LOW] == `CLINT_ADDR_MATCH);
 assign spi_addr_match   = (dbus_addr[`PERI_SEL_ADDR_HIGH:`PERI_SEL_ADDR_LOW] == `SPI_ADDR_MATCH);
 
+// The simulation control register only exists for the verilator testbench
+`ifdef VERILATOR
+assign sim_ctrl_addr_match = (dbus_addr[`PERI_SEL_ADDR_HIGH:`PERI_SEL_ADDR_LOW] == `SIM_CTRL_ADDR_MATCH);
+`else
+assign sim_ctrl_addr_match = 1'b0;
+`endif
+
 //=================================== Store operation =====================================//
 // Prepare the write data and mask for store  
 always_comb begin
@@ -146,9 +157,12 @@ always_comb begin
     uart_sel  = 1'b0;
     bmem_sel  = 1'b0;
     spi_sel   = 1'b0;
+    sim_ctrl_sel = 1'b0;
     
     if ((dmem_addr_match & dbus_req) | dcache_flush_i) begin
         dmem_sel  = 1'b1;
+    end else if (~sbuf_empty_i) begin
+        // Peripheral accesses wait for the buffered data memory stores to keep their order
     end else if (clint_addr_match & dbus_req) begin
         clint_sel = 1'b1;
     end else if (plic_addr_match & dbus_req) begin
@@ -159,6 +173,18 @@ always_comb begin
         spi_sel  = 1'b1;
     end else if (bmem_addr_match & dbus_req) begin
         bmem_sel  = 1'b1;
+    end else if (sim_ctrl_addr_match & dbus_req) begin
+        sim_ctrl_sel = 1'b1;
+    end
+end
+
+// Simulation control register acknowledges the access after one cycle, 
+// stores to it are observed by the testbench to end the simulation
+always_ff @(posedge clk) begin
+    if (~rst_n) begin
+        sim_ctrl_ack_ff <= 1'b0;
+    end else begin
+        sim_ctrl_ack_ff <= sim_ctrl_sel & ~sim_ctrl_ack_ff;
     end
 end
 
@@ -185,6 +211,7 @@ assign dbus2lsu_o = dmem_sel  ? type_dbus2lsu_s'(dcache2dbus_i)
                   : uart_sel  ? type_dbus2lsu_s'(uart2dbus_i)  
                   : spi_sel   ? type_dbus2lsu_s'(spi2dbus_i)
                   : bmem_sel  ? type_dbus2lsu_s'(bmem2dbus_i)  
+                  : sim_ctrl_sel ? type_dbus2lsu_s'({`XLEN'b0, sim_ctrl_ack_ff})
                   : '0;
 
 endmodule : dbus_interconnect
@@ -20,7 +20,7 @@ module dcache_tb;
     type_mem2dcache_s mem2dcache;
     type_dcache2mem_s dcache2mem;
     wire dcache2mem_kill;
-    logic [10:0] index;
+    logic [DCACHE_IDX_BITS-1:0] index;
     logic wrb;
 
     // Instantiate the Data Cache Top Module
@@ -152,15 +152,44 @@ module dcache_tb;
             display_cacheline(addr);
         end
     endtask
+    task cache_evict_miss(input [DCACHE_ADDR_WIDTH-1:0] addr, input [DCACHE_DATA_WIDTH-1:0] data,
+                          input [DCACHE_ADDR_WIDTH-1:0] victim_addr);
+        begin
+            @(posedge clk);
+            mem2dcache.ack=0;
+            lsummu2dcache.req = 1;
+            lsummu2dcache.w_en = 1;
+            lsummu2dcache.addr = addr;
+            lsummu2dcache.w_data = data;
+            $display("================================");
+            $display("=                              =");
+            $display("=   Cache Way Conflict Test    =");
+            $display("=                              =");
+            $display("================================");
+            repeat(2)@(posedge clk);
+            // All the ways of the set hold dirty lines, so the miss writes back the pseudo-LRU way
+            if (dcache.wb_dcache_controller_module.dcache_miss && dcache.wb_dcache_controller_module.cache_evict_req_i
+                && dcache2mem.w_en && (dcache2mem.addr == victim_addr)) begin
+            	$display("------Success------");
+            end else if (dcache.wb_dcache_controller_module.dcache_hit) begin
+            	$display("------Failure------");
+            end else begin
+            	$display("------Anomaly------ writeback of %h expected, got %h (w_en %b)", victim_addr, dcache2mem.addr, dcache2mem.w_en);
+            end
+            repeat(20)@(posedge clk);
+            mem2dcache.ack=1;
+            repeat(3)@(posedge clk);
+        end
+    endtask
     task display_cacheline(input [DCACHE_ADDR_WIDTH-1:0] addr);
     begin
-          index=addr[14:4];
-          $display("Cache-line with %h at index %h  = %h", addr, index, dcache.wb_dcache_datapath_module.dcache_data_ram_module.dcache_dataram[index]);
+          index=addr[DCACHE_TAG_LSB-1:DCACHE_OFFSET_BITS];
+          $display("Cache-line with %h at index %h  = %h", addr, index, dcache.wb_dcache_datapath_module.gen_way[0].dcache_data_ram_module.dcache_dataram[index]);
           end
     endtask
     task display_read_data(input [DCACHE_ADDR_WIDTH-1:0] addr);
     begin
-          index=addr[14:4];
+          index=addr[DCACHE_TAG_LSB-1:DCACHE_OFFSET_BITS];
           $display("\nREADING CACHE-LINE");
           $display("Cache-line with %h at index %h  = %h", addr, index, dcache2lsummu.r_data);
           end
@@ -388,6 +417,59 @@ module dcache_tb;
         display_cacheline(32'h80007ff0);
         repeat(10)@(posedge clk);
         //------------------------------------------------------------------------------------------------------------------------
+        // Way conflict, fill every way of a set with dirty lines of different tags
+        for (int way = 0; way < DCACHE_NO_OF_WAYS; way++) begin
+            dmem_sel_i=1;
+            lsummu2dcache.sel_byte=4'b1111;
+            mem2dcache.r_data={4{32'h5a5a0000 + way}};
+            cache_write_miss(32'h80000500 + way*(1 << DCACHE_TAG_LSB), 32'hd0d0d000 + way);
+            if (wrb) begin
+            	$display("------Failure------ writeback while the set has an invalid way");
+            end
+            while(!dcache2lsummu.ack) begin
+            	@(posedge clk);
+            end
+            lsummu2dcache.req = 0;
+            lsummu2dcache.w_en = 0;
+            repeat(10)@(posedge clk);
+        end
+        //------------------------------------------------------------------------------------------------------------------------
+        // Way conflict, one more tag evicts the least recently used way (the first one filled)
+        dmem_sel_i=1;
+        lsummu2dcache.sel_byte=4'b1111;
+        mem2dcache.r_data=128'h6b6b6b6b6b6b6b6b6b6b6b6b6b6b6b6b;
+        cache_evict_miss(32'h80000500 + DCACHE_NO_OF_WAYS*(1 << DCACHE_TAG_LSB), 32'he1e1e1e1, 32'h80000500);
+        while(!dcache2lsummu.ack) begin
+        	@(posedge clk);
+        end
+        lsummu2dcache.req = 0;
+        lsummu2dcache.w_en = 0;
+        repeat(10)@(posedge clk);
+        //------------------------------------------------------------------------------------------------------------------------
+        // Way conflict, the other ways of the set are still resident
+        for (int way = 1; way < DCACHE_NO_OF_WAYS; way++) begin
+            dmem_sel_i=1;
+            cache_read_hit(32'h80000500 + way*(1 << DCACHE_TAG_LSB));
+            while(!dcache2lsummu.ack) begin
+            	@(posedge clk);
+            end
+            lsummu2dcache.req = 0;
+            if (dcache2lsummu.r_data != 32'hd0d0d000 + way) begin
+            	$display("------Failure------ read %h from way %0d", dcache2lsummu.r_data, way);
+            end
+            repeat(10)@(posedge clk);
+        end
+        //------------------------------------------------------------------------------------------------------------------------
+        // Way conflict, the evicted line misses again
+        dmem_sel_i=1;
+        mem2dcache.r_data=128'h7c7c7c7c7c7c7c7c7c7c7c7c7c7c7c7c;
+        cache_read_miss(32'h80000500);
+        while(!dcache2lsummu.ack) begin
+        	@(posedge clk);
+        end
+        lsummu2dcache.req = 0;
+        repeat(10)@(posedge clk);
+        //------------------------------------------------------------------------------------------------------------------------
         // Cache read without dmem_sel
         @(posedge clk);
         dmem_sel_i=0;
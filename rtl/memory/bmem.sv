@@ -1004,7 +1004,25 @@ end
 
 `endif
 
+`ifdef VERILATOR
+// Boot image loaded by the C++ testbench (+bmem=<file>), it replaces the
+// above contents for simulation when the plusarg is given
+logic [`XLEN-1:0]                      bmem_image[1024];
+logic [`XLEN-1:0]                      bmem_image_data;
+logic                                  bmem_image_en;
+
+initial begin
+    bmem_image_en = $test$plusargs("bmem=");
+end
+
+always @ (posedge clk) begin
+    bmem_image_data <= bmem_image[if2bmem_addr_i[11:2]];
+end
+
+assign bmem2if_data_o = bmem_image_en ? bmem_image_data : r_data;
+`else
 assign bmem2if_data_o = r_data;
+`endif
 
 endmodule : bmem
 
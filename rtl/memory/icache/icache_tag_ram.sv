@@ -37,6 +37,14 @@ reg [DATA_WIDTH-1:0] icache_tagram [ICACHE_NO_OF_SETS-1:0];
 
 // Port read write operation
 always @ (posedge clk) begin
+`ifdef VERILATOR
+   // Simulation only: the batch mode of the testbench loads the next
+   // image under reset, no line of the previous image may stay valid
+   if (~rst_n) begin
+      for (int set = 0; set < ICACHE_NO_OF_SETS; set++)
+         icache_tagram[set] <= '0;
+   end else
+`endif
    if (req) begin
       if (wr_en) begin
          icache_tagram[addr] <= wdata;
@@ -50,21 +50,30 @@ logic [ICACHE_DATA_WIDTH-1:0]        icache2if_data_ff, icache2if_data_next;
 logic [`XLEN-1:0]                    icache_wr_tag;
 logic [ICACHE_TAG_BITS-1:0]          addr_tag, addr_tag_ff;
 logic [1:0]                          addr_offset, addr_offset_ff;
-logic [ICACHE_IDX_BITS-1:0]          addr_index;
+logic [ICACHE_IDX_BITS-1:0]          addr_index, addr_index_ff;
 
 logic [ICACHE_IDX_BITS-1:0]          flush_index_next, flush_index_ff;
 logic                                icache_flush_ff;
 logic                                icache_flush_done;
 
-// 2-way associativity related signal definitions
+// Set associativity related signal definitions
 logic [ICACHE_LINE_WIDTH-1:0]        icache_rd_data; 
-logic [ICACHE_LINE_WIDTH-1:0]        icache_rd_data_way[0:3];
-logic [`XLEN-1:0]                    icache_rd_tag_way[0:3]; 
-logic [1:0]                          replace_way_ff; 
-logic [3:0]                          cache_wr_way; 
-logic [3:0]                          cache_hit_way; 
+logic [ICACHE_LINE_WIDTH-1:0]        icache_rd_data_way[ICACHE_NO_OF_WAYS];
+logic [`XLEN-1:0]                    icache_rd_tag_way[ICACHE_NO_OF_WAYS]; 
+logic [ICACHE_WAY_BITS-1:0]          replace_way_next, replace_way_ff; 
+logic [ICACHE_NO_OF_WAYS-1:0]        cache_wr_way; 
+logic [ICACHE_NO_OF_WAYS-1:0]        cache_hit_way; 
+logic [ICACHE_NO_OF_WAYS-1:0]        cache_valid_way; 
+logic [ICACHE_WAY_BITS-1:0]          hit_way; 
+
+// Tree pseudo-LRU state, one bit per tree node of each set
+localparam PLRU_BITS = (ICACHE_NO_OF_WAYS > 1) ? ICACHE_NO_OF_WAYS-1 : 1;
+
+logic [PLRU_BITS-1:0]                plru_ff[ICACHE_NO_OF_SETS];
+logic [PLRU_BITS-1:0]                plru_hit_next, plru_fill_next;
+logic [ICACHE_WAY_BITS-1:0]          plru_victim_way;
+logic                                plru_fill;
 
-logic valid0,valid1,valid2,valid3;
 logic flush;
 
 assign if2icache         = if2icache_i;
@@ -72,40 +81,12 @@ assign mem2icache.r_data = mem2icache_i.r_data;
 assign mem2icache.ack    = mem2icache_i.ack;
 
 assign icache_flush = if2icache.icache_flush || icache_flush_ff;
-// Muxes for cache validity 
-always_comb begin
-    if (icache_rd_tag_way[0][31]) begin
-        valid0 = 1'b1;
-    end else begin
-    	valid0 = 1'b0;
-    end
-end
-always_comb begin
-    if (icache_rd_tag_way[1][31]) begin
-        valid1= 1'b1;
-    end else begin
-    	valid1 = 1'b0;
-    end
-end
-always_comb begin
-    if (icache_rd_tag_way[2][31]) begin
-        valid2 = 1'b1;
-    end else begin
-    	valid2 = 1'b0;
-    end
+// Parallel tag compare of all the ways
+for (genvar way = 0; way < ICACHE_NO_OF_WAYS; way++) begin : gen_hit_way
+    assign cache_valid_way[way] = icache_rd_tag_way[way][31];
+    assign cache_hit_way[way]   = cache_valid_way[way] && 
+                                  (icache_rd_tag_way[way][ICACHE_TAG_BITS-1:0] == addr_tag_ff);
 end
-always_comb begin
-    if (icache_rd_tag_way[3][31]) begin
-        valid3 = 1'b1;
-    end else begin
-    	valid3 = 1'b0;
-    end
-end
-
-assign cache_hit_way[0] = valid0 && (icache_rd_tag_way[0][ICACHE_TAG_BITS-1:0] == addr_tag_ff);
-assign cache_hit_way[1] = valid1 && (icache_rd_tag_way[1][ICACHE_TAG_BITS-1:0] == addr_tag_ff);
-assign cache_hit_way[2] = valid2 && (icache_rd_tag_way[2][ICACHE_TAG_BITS-1:0] == addr_tag_ff);
-assign cache_hit_way[3] = valid3 && (icache_rd_tag_way[3][ICACHE_TAG_BITS-1:0] == addr_tag_ff);
 
 assign cache_hit   = (|cache_hit_way) && ~icache_flush; 
 assign icache_hit  = if2icache_req & imem_sel_ff & cache_hit;
@@ -118,19 +99,15 @@ assign addr_index  = icache_flush_ff ? flush_index_ff : if2icache.addr[ICACHE_TA
 
 assign icache_wr_tag  = {cache_valid_bit, {`XLEN-ICACHE_TAG_BITS-1{1'b0}}, addr_tag}; 
 
-// Select the requested word from the read cache data line
+// Select the read cache data line of the hit way, at most one way hits
 always_comb begin
-    if (cache_hit_way[3]) begin
-        icache_rd_data = icache_rd_data_way[3];
-    end
-    else if (cache_hit_way[2]) begin
-        icache_rd_data = icache_rd_data_way[2];
-    end
-    else if (cache_hit_way[1]) begin
-        icache_rd_data = icache_rd_data_way[1];
-    end
-    else begin
-        icache_rd_data = icache_rd_data_way[0];
+    icache_rd_data = '0;
+    hit_way        = '0;
+    for (int unsigned way = 0; way < ICACHE_NO_OF_WAYS; way++) begin
+        if (cache_hit_way[way]) begin
+            icache_rd_data = icache_rd_data | icache_rd_data_way[way];
+            hit_way        = hit_way | ICACHE_WAY_BITS'(way);
+        end
     end
 end
 
@@ -150,32 +127,69 @@ always_ff@(posedge clk) begin
   if(!rst_n) begin
       addr_tag_ff    <= '0;
       addr_offset_ff <= '0;
+      addr_index_ff  <= '0;
       if2icache_req  <= '0;
       imem_sel_ff    <= '0;
   end else begin
       addr_tag_ff    <= addr_tag;
       addr_offset_ff <= addr_offset;
+      addr_index_ff  <= addr_index;
       if2icache_req  <= if2icache.req;
       imem_sel_ff    <= imem_sel_i;
   end
 end
 
 
-// 2-way associativity
-always @ (posedge clk) begin
+// Replacement way, the first invalid way of the set or else the pseudo-LRU way
+always_comb begin
+    replace_way_next = plru_victim_way;
+    for (int way = ICACHE_NO_OF_WAYS-1; way >= 0; way--) begin
+        if (~cache_valid_way[way]) begin
+            replace_way_next = ICACHE_WAY_BITS'(way);
+        end
+    end
+end
+
+always_ff @(posedge clk) begin
     if (!rst_n) begin
         replace_way_ff <= '0;
-    end else if (icache_rd_tag_way[0][31]&icache_rd_tag_way[1][31]&icache_rd_tag_way[2][31]&icache_rd_tag_way[3][31]) begin
-        replace_way_ff <= '0;
-    end else if (icache_rd_tag_way[0][31]&icache_rd_tag_way[1][31]&icache_rd_tag_way[2][31]) begin
-        replace_way_ff <= 2'd3;
-    end else if (icache_rd_tag_way[0][31]&icache_rd_tag_way[1][31]) begin
-        replace_way_ff <= 2'd2;
-    end else if (icache_rd_tag_way[0][31]) begin
-        replace_way_ff <= 2'd1;
+    end else begin
+        replace_way_ff <= replace_way_next;
     end
-    else begin
-    	replace_way_ff <= 2'd0;
+end
+
+// The pseudo-LRU state of a set is updated on a hit and on the refill of a line
+if (ICACHE_NO_OF_WAYS > 1) begin : gen_plru
+    plru_tree #(
+      .WAYS               (ICACHE_NO_OF_WAYS)
+    ) plru_tree_hit (
+      .plru_i             (plru_ff[addr_index_ff]),
+      .access_way_i       (hit_way),
+      .plru_o             (plru_hit_next),
+      .victim_way_o       (plru_victim_way)
+    );
+
+    plru_tree #(
+      .WAYS               (ICACHE_NO_OF_WAYS)
+    ) plru_tree_fill (
+      .plru_i             (plru_ff[addr_index]),
+      .access_way_i       (replace_way_ff),
+      .plru_o             (plru_fill_next),
+      .victim_way_o       ()
+    );
+end else begin : gen_no_plru
+    assign plru_hit_next   = '0;
+    assign plru_fill_next  = '0;
+    assign plru_victim_way = '0;
+end
+
+always_ff @(posedge clk) begin
+    if (!rst_n) begin
+        plru_ff <= '{default: '0};
+    end else if (plru_fill) begin
+        plru_ff[addr_index] <= plru_fill_next;
+    end else if (icache_hit) begin
+        plru_ff[addr_index_ff] <= plru_hit_next;
     end
 end
 
@@ -208,9 +222,10 @@ always_comb begin
     icache_state_next = icache_state_ff;
     flush_index_next  = '0; //flush_index_ff;
     icache2mem.req    = '0;
-    cache_wr_way      = 4'h0;
+    cache_wr_way      = '0;
     cache_valid_bit   = 1'b0;
     icache_flush_done = 1'b0;
+    plru_fill         = 1'b0;
     flush=0;
     
     unique case (icache_state_ff)
@@ -236,21 +251,15 @@ always_comb begin
                 icache_state_next = ICACHE_IDLE;
                 cache_valid_bit = 1'b1;
                 icache2mem.req = 1'b0;
-                if (replace_way_ff == 2'd3)
-                    cache_wr_way[3] = 1'b1;
-                else if (replace_way_ff == 2'd2)
-                    cache_wr_way[2] = 1'b1;
-                else if (replace_way_ff == 2'd1)
-                    cache_wr_way[1] = 1'b1;
-                else 
-                    cache_wr_way[0] = 1'b1;
+                plru_fill      = 1'b1;
+                cache_wr_way[replace_way_ff] = 1'b1;
             end else begin
                 icache_state_next = ICACHE_READ_MEMORY;
                 icache2mem.req = 1'b1;
             end
         end
         ICACHE_FLUSH: begin
-            cache_wr_way    = 4'hF;
+            cache_wr_way    = '1;
             flush=1;    
             if (&flush_index_ff) begin  
                 icache_state_next = ICACHE_FLUSH_DONE;
@@ -272,7 +281,8 @@ always_comb begin
     //     1) The new PC points to boot memory region (only happens on reset) 
     if (~imem_sel_i) begin 
         icache_state_next = ICACHE_IDLE;
-        cache_wr_way   = 4'h0;    
+        cache_wr_way   = '0;    
+        plru_fill      = 1'b0;
         icache2mem.req = 1'b0;
         icache2mem.kill = 1'b0;
     end
@@ -280,64 +290,20 @@ always_comb begin
 end
 
 
-icache_data_ram icache_data_ram_module0 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .addr                 (addr_index),
-  .wdata                (mem2icache.r_data),
-  .wr_en                (cache_wr_way[0]),
-  .rdata                (icache_rd_data_way[0])  
-);
- 
-icache_tag_ram icache_tag_ram_module0 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .flush		(flush),
-  .addr                 (addr_index),
-  .wdata                (icache_wr_tag),
-  .wr_en                (cache_wr_way[0]),
-  .rdata                (icache_rd_tag_way[0])
-);
-
-icache_data_ram icache_data_ram_module1 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .addr                 (addr_index),
-  .wdata                (mem2icache.r_data),
-  .wr_en                (cache_wr_way[1]),
-  .rdata                (icache_rd_data_way[1])  
-);
+for (genvar way = 0; way < ICACHE_NO_OF_WAYS; way++) begin : gen_way
 
-icache_tag_ram icache_tag_ram_module1 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .flush		(flush),
-  .addr                 (addr_index),
-  .wdata                (icache_wr_tag),
-  .wr_en                (cache_wr_way[1]),
-  .rdata                (icache_rd_tag_way[1])
-);
-
-icache_data_ram icache_data_ram_module2 (
+icache_data_ram icache_data_ram_module (
   .clk                  (clk), 
   .rst_n                (rst_n),
 
   .req                  (cache_req),
   .addr                 (addr_index),
   .wdata                (mem2icache.r_data),
-  .wr_en                (cache_wr_way[2]),
-  .rdata                (icache_rd_data_way[2])  
+  .wr_en                (cache_wr_way[way]),
+  .rdata                (icache_rd_data_way[way])  
 );
-
-icache_tag_ram icache_tag_ram_module2 (
+ 
+icache_tag_ram icache_tag_ram_module (
   .clk                  (clk), 
   .rst_n                (rst_n),
 
@@ -345,32 +311,11 @@ icache_tag_ram icache_tag_ram_module2 (
   .flush		(flush),
   .addr                 (addr_index),
   .wdata                (icache_wr_tag),
-  .wr_en                (cache_wr_way[2]),
-  .rdata                (icache_rd_tag_way[2])
+  .wr_en                (cache_wr_way[way]),
+  .rdata                (icache_rd_tag_way[way])
 );
 
-icache_data_ram icache_data_ram_module3 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .addr                 (addr_index),
-  .wdata                (mem2icache.r_data),
-  .wr_en                (cache_wr_way[3]),
-  .rdata                (icache_rd_data_way[3])  
-);
-
-icache_tag_ram icache_tag_ram_module3 (
-  .clk                  (clk), 
-  .rst_n                (rst_n),
-
-  .req                  (cache_req),
-  .flush		(flush),
-  .addr                 (addr_index),
-  .wdata                (icache_wr_tag),
-  .wr_en                (cache_wr_way[3]),
-  .rdata                (icache_rd_tag_way[3])
-);
+end
 
 // Generate the response for the fetch stage
 always_comb begin
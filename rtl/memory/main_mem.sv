@@ -43,7 +43,20 @@ logic                       response_flag;
 
 
 // Dual port memory instantiation and initialization
+`ifdef SPARSE_MEM
+// Simulation-only memory backed by host pages that are allocated on first
+// write (bench/sparse_mem.cpp), host memory grows with the guest footprint
+import "DPI-C" function int  sparse_mem_read(input int word_addr);
+import "DPI-C" function void sparse_mem_write(input int word_addr, input int data);
+import "DPI-C" function void sparse_mem_load_hex(input string filename);
+`else
 logic [`XLEN-1:0]          dualport_memory[`IDMEM_SIZE];
+`ifdef VERILATOR
+// 4 KB pages written since the last clear, the batch mode of the testbench 
+// only zeroes these pages between images
+logic                      mem_touched[1 << (`MEM_ADDR_WIDTH-12)];
+`endif
+`endif
 
 `ifdef COMPLIANCE
 initial
@@ -56,7 +69,11 @@ end
 initial 
 begin
     // Reading the contents of example imem.txt file to memory variable
+`ifdef SPARSE_MEM
+     sparse_mem_load_hex("imem.txt");
+`else
      $readmemh("imem.txt", dualport_memory);  
+`endif
 end
 //`endif
 `else
@@ -80,11 +97,27 @@ always_ff @(posedge clk) begin
 
     if (mem_req & ~mem2cache.ack & response_flag) begin // 
         
+`ifdef SPARSE_MEM
+        if (mem_wen) begin
+            sparse_mem_write({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b00}, cache2mem.w_data[31:0]);
+            sparse_mem_write({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b01}, cache2mem.w_data[63:32]);
+            sparse_mem_write({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b10}, cache2mem.w_data[95:64]);
+            sparse_mem_write({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b11}, cache2mem.w_data[127:96]);
+        end else begin
+            mem2cache.r_data[31:0]   <= sparse_mem_read({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b00});
+            mem2cache.r_data[63:32]  <= sparse_mem_read({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b01});
+            mem2cache.r_data[95:64]  <= sparse_mem_read({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b10});
+            mem2cache.r_data[127:96] <= sparse_mem_read({mem_addr[`MEM_ADDR_WIDTH-1:2],2'b11});
+        end
+`else
         if (mem_wen) begin
             dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b00}] <= cache2mem.w_data[31:0];
             dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b01}] <= cache2mem.w_data[63:32];
             dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b10}] <= cache2mem.w_data[95:64];
             dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b11}] <= cache2mem.w_data[127:96];
+`ifdef VERILATOR
+            mem_touched[cache2mem.addr[`MEM_ADDR_WIDTH-1:12]]   <= 1'b1;
+`endif
         end else begin
           //  dmem2dbus_ff.r_data <= dualport_memory[dmem_addr_ff];
             mem2cache.r_data[31:0]   <= dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b00}];   
@@ -93,6 +126,7 @@ always_ff @(posedge clk) begin
             mem2cache.r_data[127:96] <= dualport_memory[{mem_addr[`MEM_ADDR_WIDTH-1:2],2'b11}]; 
             
         end
+`endif
 
         mem2cache.ack <= 1'b1;
     end else begin
@@ -38,6 +38,7 @@ module mem_top (
     output  type_peri2dbus_s                        bmem2dbus_o,             // Boot memory output signals
     input wire                                      dcache_flush_i,
     input wire                                      lsu_flush_i,
+    output logic                                    sbuf_empty_o,            // No store is buffered for the data cache
 
 `ifdef DRAM
     // DDR memory interface
@@ -47,7 +48,10 @@ module mem_top (
 
  // Selection signal from address decoder of dbus interconnect 
     input   logic                                   dmem_sel_i,
-    input   logic                                   bmem_sel_i
+    input   logic                                   bmem_sel_i,
+
+ // Hardware performance monitor events
+    output  type_mem2hpm_s                          mem2hpm_o
 );
 
 
@@ -85,6 +89,17 @@ logic                                   bmem_iaddr_match;
 logic                                   dcache_kill_req;
 logic                                   dcache2mem_kill;
 
+// Store buffer signals
+type_lsummu2dcache_s                    sbuf2dcache;
+logic [`XLEN-1:0]                       sbuf_ld_data;
+logic                                   sbuf_st_ack;
+logic                                   sbuf_ld_fwd;
+logic                                   sbuf_ld_match;
+logic                                   sbuf_drain;
+logic                                   sbuf_drain_ack;
+logic                                   sbuf_empty;
+logic                                   lsu_sbuf_req;
+
 logic                                   timeout_flag;
 logic [5:0]                             timeout_next, timeout_ff; 
 
@@ -130,7 +145,33 @@ icache_top icache_top_module(
 );
 
 //============ Data cache, bus arbiter and associated interfaces =============//
-// Arbitration between LSU and MMU interfaces for data cache access
+// Stores to the data memory are written to the store buffer and drain to the data cache
+store_buffer store_buffer_module (
+    .clk                    (clk),
+    .rst_n                  (rst_n),
+
+    // Data bus to store buffer interface
+    .dbus2sbuf_i            (dbus2peri),
+    .dmem_sel_i             (dmem_sel),
+    .lsu_flush_i            (lsu_flush_i),
+    .sbuf_st_ack_o          (sbuf_st_ack),
+    .sbuf_ld_fwd_o          (sbuf_ld_fwd),
+    .sbuf_ld_match_o        (sbuf_ld_match),
+    .sbuf_ld_data_o         (sbuf_ld_data),
+
+    // Store buffer to data cache interface
+    .sbuf_drain_i           (sbuf_drain),
+    .sbuf_drain_ack_i       (sbuf_drain_ack),
+    .sbuf2dcache_o          (sbuf2dcache),
+    .sbuf_empty_o           (sbuf_empty)
+);
+
+// LSU requests that are served by the store buffer rather than the data cache
+assign lsu_sbuf_req = dmem_sel & dbus2peri.req & (dbus2peri.w_en | sbuf_ld_match);
+
+// Arbitration between LSU, store buffer and MMU interfaces for data cache access.
+// The buffered stores drain before a data cache flush and before a page table walk 
+// reads the data cache.
 
 always_ff @(posedge clk) begin
     if (~rst_n) begin
@@ -146,17 +187,23 @@ dcache2dbus   = '0;
 dcache2mmu    = '0;
 cache_arbiter_state_next  = cache_arbiter_state_ff;
 dcache_kill_req = '0;
+sbuf_drain      = '0;
+sbuf_drain_ack  = '0;
 
    case (cache_arbiter_state_ff)
 
        DCACHE_ARBITER_IDLE: begin
-           if (dmem_sel) begin
+           if (dmem_sel & ~lsu_sbuf_req & ~(dcache_flush_i & ~sbuf_empty)) begin
                lsummu2dcache.addr     = dbus2peri.addr;
                lsummu2dcache.w_data   = dbus2peri.w_data;
                lsummu2dcache.sel_byte = dbus2peri.sel_byte;
                lsummu2dcache.w_en     = dbus2peri.w_en;
                lsummu2dcache.req      = dbus2peri.req;
                cache_arbiter_state_next = DCACHE_ARBITER_LSU;
+           end else if (~sbuf_empty) begin
+               lsummu2dcache = sbuf2dcache;
+               sbuf_drain    = 1'b1;
+               cache_arbiter_state_next = DCACHE_ARBITER_SBUF;
            end else if (~dmem_sel & mmu2dcache.r_req & ~mmu2dcache.flush_req) begin
                lsummu2dcache.addr     = mmu2dcache.paddr;
                lsummu2dcache.w_data   = '0;
@@ -168,7 +215,11 @@ dcache_kill_req = '0;
        end
 
        DCACHE_ARBITER_LSU: begin
-           if (dcache2lsummu.ack) begin
+           if (lsu_sbuf_req) begin
+               // The load was flushed and the next request is for the store buffer
+               cache_arbiter_state_next = DCACHE_ARBITER_IDLE;
+               dcache_kill_req = 1'b1;
+           end else if (dcache2lsummu.ack) begin
                dcache2dbus.r_data = dcache2lsummu.r_data;
                dcache2dbus.ack    = 1'b1;
                cache_arbiter_state_next = DCACHE_ARBITER_IDLE;
@@ -201,8 +252,25 @@ dcache_kill_req = '0;
            end 
        end
 
+       DCACHE_ARBITER_SBUF: begin
+           if (dcache2lsummu.ack) begin
+               sbuf_drain_ack = 1'b1;
+               cache_arbiter_state_next = DCACHE_ARBITER_IDLE;
+           end else begin
+               cache_arbiter_state_next = DCACHE_ARBITER_SBUF;
+               lsummu2dcache = sbuf2dcache;
+           end 
+           sbuf_drain = 1'b1;
+       end
+
       default: begin     end
    endcase
+
+   // Stores and the loads forwarded from the store buffer are acknowledged in any state
+   if (sbuf_st_ack | sbuf_ld_fwd) begin
+       dcache2dbus.r_data = sbuf_ld_data;
+       dcache2dbus.ack    = 1'b1;
+   end
  
 end 
 
@@ -220,8 +288,8 @@ wb_dcache_top wb_dcache_top_module(
     // Data cache to main memory interface  
     .mem2dcache_i           (mem2dcache),
     .dcache2mem_o           (dcache2mem),
-    .dcache_flush_i         (dcache_flush_i),
-    .dmem_sel_i             (dmem_sel | mmu2dcache.r_req)
+    .dcache_flush_i         (dcache_flush_i & sbuf_empty),
+    .dmem_sel_i             (dmem_sel | mmu2dcache.r_req | sbuf_drain)
 );
 
 //============================= Main memory and its memory interface =============================//
@@ -355,10 +423,36 @@ assign cache2dram_o = cache2mem;
 assign mem2cache = dram2cache_i;
 `endif
 
+//=========================== Hardware performance monitor events ===========================//
+// A miss or writeback is counted in the cycle its main memory request starts
+logic                                   icache2mem_req_ff;
+logic                                   dcache2mem_rd_ff, dcache2mem_wr_ff;
+logic                                   dcache2mem_rd, dcache2mem_wr;
+
+assign dcache2mem_rd = dcache2mem.req & ~dcache2mem.w_en;
+assign dcache2mem_wr = dcache2mem.req & dcache2mem.w_en;
+
+always_ff @(posedge clk) begin
+    if (~rst_n) begin
+        icache2mem_req_ff <= 1'b0;
+        dcache2mem_rd_ff  <= 1'b0;
+        dcache2mem_wr_ff  <= 1'b0;
+    end else begin
+        icache2mem_req_ff <= icache2mem.req;
+        dcache2mem_rd_ff  <= dcache2mem_rd;
+        dcache2mem_wr_ff  <= dcache2mem_wr;
+    end
+end
+
+assign mem2hpm_o.icache_miss = icache2mem.req & ~icache2mem_req_ff;
+assign mem2hpm_o.dcache_miss = dcache2mem_rd & ~dcache2mem_rd_ff;
+assign mem2hpm_o.dcache_wrb  = dcache2mem_wr & ~dcache2mem_wr_ff;
+
 // Output signal assignments
 assign icache2if_o  = bmem2if.ack ? bmem2if : icache2if; 
 assign bmem2dbus_o  = bmem2dbus;
 assign dcache2dbus_o = dcache2dbus;  
 assign dcache2mmu_o  = dcache2mmu; 
+assign sbuf_empty_o  = sbuf_empty;
 
 endmodule : mem_top
@@ -0,0 +1,43 @@
+// Copyright 2023 University of Engineering and Technology Lahore.
+// Licensed under the Apache License, Version 2.0, see LICENSE file for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Description: Tree pseudo-LRU replacement state of one cache set. The WAYS-1 bits
+//              form a binary tree stored in heap order (node n has children 2n+1
+//              and 2n+2), each bit points to the subtree holding the victim: 0 for
+//              the lower ways and 1 for the upper ways. An access turns the bits on
+//              its path away from the accessed way.
+//
+
+
+module plru_tree
+#(
+parameter WAYS       = 4,                         // Power of 2, at least 2
+parameter WAY_BITS   = $clog2(WAYS)
+) (
+  input  wire logic [WAYS-2:0]      plru_i,       // Current state of the set
+  input  wire logic [WAY_BITS-1:0]  access_way_i, // Way that is hit or refilled
+  output logic      [WAYS-2:0]      plru_o,       // State after the access
+  output logic      [WAY_BITS-1:0]  victim_way_o  // Way to replace
+);
+
+int unsigned victim_node, access_node;
+
+always_comb begin
+    victim_node = 0;
+    for (int unsigned level = 0; level < WAY_BITS; level++) begin
+        victim_node = 2*victim_node + 1 + plru_i[victim_node];
+    end
+    victim_way_o = WAY_BITS'(victim_node - (WAYS - 1));
+end
+
+always_comb begin
+    plru_o      = plru_i;
+    access_node = 0;
+    for (int unsigned level = 0; level < WAY_BITS; level++) begin
+        plru_o[access_node] = ~access_way_i[WAY_BITS-1-level];
+        access_node = 2*access_node + 1 + access_way_i[WAY_BITS-1-level];
+    end
+end
+
+endmodule : plru_tree
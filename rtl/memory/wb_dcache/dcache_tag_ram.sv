@@ -41,6 +41,14 @@ genvar i;
 
     for (i=0; i < NUM_COL; i++) begin
         always_ff @(posedge clk) begin
+`ifdef VERILATOR
+            // Simulation only: the batch mode of the testbench loads the
+            // next image under reset, no valid or dirty line may remain
+            if (~rst_n) begin
+                for (int set = 0; set < DCACHE_NO_OF_SETS; set++)
+                    dcache_tagram[set][i*COL_WIDTH +: COL_WIDTH] <= '0;
+            end else
+`endif
           //  if (en_a) begin
                 if (wr_en[i]) begin
                     dcache_tagram[addr][i*COL_WIDTH +: COL_WIDTH] <= wdata[i*COL_WIDTH +: COL_WIDTH];
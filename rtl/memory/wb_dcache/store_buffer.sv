@@ -0,0 +1,138 @@
+// Copyright 2023 University of Engineering and Technology Lahore.
+// Licensed under the Apache License, Version 2.0, see LICENSE file for details.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Description: Store buffer between the data bus and the data cache. Stores to the
+//              data memory are acknowledged as soon as they are written to the 
+//              buffer and drain to the data cache in order. A store to a word that
+//              is already buffered is merged in its entry, except for the entry 
+//              being drained. A load forwards the word from the buffer when its 
+//              bytes are all buffered, otherwise a load to a buffered word waits 
+//              until the word has drained.
+//
+
+
+`ifndef VERILATOR
+`include "../../defines/cache_defs.svh"
+`else
+`include "cache_defs.svh"
+`endif
+
+module store_buffer (
+    input wire                         clk,
+    input wire                         rst_n,
+
+    // Data bus to store buffer interface
+    input wire type_dbus2peri_s        dbus2sbuf_i,
+    input wire                         dmem_sel_i,
+    input wire                         lsu_flush_i,
+    output logic                       sbuf_st_ack_o,        // Store is written to the buffer
+    output logic                       sbuf_ld_fwd_o,        // Load is forwarded from the buffer
+    output logic                       sbuf_ld_match_o,      // Load has to wait for the drain
+    output logic [`XLEN-1:0]           sbuf_ld_data_o,
+
+    // Store buffer to data cache interface
+    input wire                         sbuf_drain_i,         // Oldest entry is being written to cache
+    input wire                         sbuf_drain_ack_i,
+    output type_lsummu2dcache_s        sbuf2dcache_o,
+    output logic                       sbuf_empty_o
+);
+
+localparam SBUF_AWIDTH = $clog2(DCACHE_SBUF_ENTRIES);
+
+type_dcache_sbuf_entry_s               sbuf_ff[DCACHE_SBUF_ENTRIES];
+logic [DCACHE_SBUF_ENTRIES-1:0]        sbuf_valid_ff;
+logic [SBUF_AWIDTH-1:0]                sbuf_head_ff, sbuf_tail_ff;
+
+logic [DCACHE_ADDR_WIDTH-1:2]          word_addr;
+logic                                  st_req, ld_req;
+logic                                  st_merge, st_alloc, st_wr;
+logic [SBUF_AWIDTH-1:0]                st_merge_idx;
+logic                                  sbuf_full;
+logic [3:0]                            ld_fwd_bytes;
+logic [SBUF_AWIDTH-1:0]                sbuf_idx;
+
+assign word_addr = dbus2sbuf_i.addr[DCACHE_ADDR_WIDTH-1:2];
+assign st_req    = dmem_sel_i & dbus2sbuf_i.req &  dbus2sbuf_i.w_en;
+assign ld_req    = dmem_sel_i & dbus2sbuf_i.req & ~dbus2sbuf_i.w_en;
+assign sbuf_full = sbuf_valid_ff[sbuf_tail_ff];
+
+// Buffered word of the store, the oldest entry can not be merged while it is drained
+always_comb begin
+    st_merge     = 1'b0;
+    st_merge_idx = '0;
+    for (int unsigned i = 0; i < DCACHE_SBUF_ENTRIES; i++) begin
+        if (sbuf_valid_ff[i] && (sbuf_ff[i].addr == word_addr) && 
+           ~(sbuf_drain_i && (SBUF_AWIDTH'(i) == sbuf_head_ff))) begin
+            st_merge     = 1'b1;
+            st_merge_idx = SBUF_AWIDTH'(i);
+        end
+    end
+end
+
+// The store is acknowledged in the same cycle when it is merged or there is a free
+// entry. The acknowledgement does not depend on the flush to keep it off the path 
+// to the CSR unit, rather a store flushed in the same cycle is not written.
+assign st_alloc = ~st_merge & ~sbuf_full;
+assign st_wr    = st_req & (st_merge | st_alloc) & ~lsu_flush_i;
+
+// Forward the bytes of the load word from the oldest to the youngest entry
+always_comb begin
+    sbuf_ld_data_o  = '0;
+    ld_fwd_bytes    = '0;
+    sbuf_ld_match_o = 1'b0;
+    for (int unsigned i = 0; i < DCACHE_SBUF_ENTRIES; i++) begin
+        sbuf_idx = sbuf_head_ff + SBUF_AWIDTH'(i);
+        if (sbuf_valid_ff[sbuf_idx] && (sbuf_ff[sbuf_idx].addr == word_addr)) begin
+            sbuf_ld_match_o = ld_req;
+            ld_fwd_bytes    = ld_fwd_bytes | sbuf_ff[sbuf_idx].sel_byte;
+            for (int unsigned b = 0; b < 4; b++) begin
+                if (sbuf_ff[sbuf_idx].sel_byte[b]) begin
+                    sbuf_ld_data_o[b*8 +: 8] = sbuf_ff[sbuf_idx].w_data[b*8 +: 8];
+                end
+            end
+        end
+    end
+end
+
+assign sbuf_ld_fwd_o = sbuf_ld_match_o & (&ld_fwd_bytes);
+
+always_ff @(posedge clk) begin
+    if (!rst_n) begin
+        sbuf_valid_ff <= '0;
+        sbuf_head_ff  <= '0;
+        sbuf_tail_ff  <= '0;
+    end else begin
+        if (sbuf_drain_ack_i) begin
+            sbuf_valid_ff[sbuf_head_ff] <= 1'b0;
+            sbuf_head_ff                <= sbuf_head_ff + 1'b1;
+        end
+
+        if (st_wr & st_merge) begin
+            for (int unsigned b = 0; b < 4; b++) begin
+                if (dbus2sbuf_i.sel_byte[b]) begin
+                    sbuf_ff[st_merge_idx].w_data[b*8 +: 8] <= dbus2sbuf_i.w_data[b*8 +: 8];
+                end
+            end
+            sbuf_ff[st_merge_idx].sel_byte <= sbuf_ff[st_merge_idx].sel_byte | dbus2sbuf_i.sel_byte;
+        end else if (st_wr) begin
+            sbuf_ff[sbuf_tail_ff].addr     <= word_addr;
+            sbuf_ff[sbuf_tail_ff].w_data   <= dbus2sbuf_i.w_data;
+            sbuf_ff[sbuf_tail_ff].sel_byte <= dbus2sbuf_i.sel_byte;
+            sbuf_valid_ff[sbuf_tail_ff]    <= 1'b1;
+            sbuf_tail_ff                   <= sbuf_tail_ff + 1'b1;
+        end
+    end
+end
+
+// The oldest entry is written to the data cache
+assign sbuf2dcache_o.addr     = {sbuf_ff[sbuf_head_ff].addr, 2'b00};
+assign sbuf2dcache_o.w_data   = sbuf_ff[sbuf_head_ff].w_data;
+assign sbuf2dcache_o.sel_byte = sbuf_ff[sbuf_head_ff].sel_byte;
+assign sbuf2dcache_o.w_en     = 1'b1;
+assign sbuf2dcache_o.req      = sbuf_valid_ff[sbuf_head_ff];
+
+assign sbuf_st_ack_o = st_req & (st_merge | st_alloc);
+assign sbuf_empty_o  = ~(|sbuf_valid_ff);
+
+endmodule : store_buffer
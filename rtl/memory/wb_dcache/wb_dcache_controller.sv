@@ -27,6 +27,7 @@ module wb_dcache_controller (
     output logic                          cache_line_wr_o,
     output logic                          cache_line_clean_o,
     output logic                          cache_wrb_req_o,
+    output logic                          cache_hit_upd_o,
     output logic [DCACHE_IDX_BITS-1:0]    evict_index_o,
 
     // LSU/MMU to data cache interface
@@ -56,6 +57,7 @@ logic                                 dcache2mem_wr;
 logic                                 dcache2mem_req;
 
 logic                                 cache_wrb_req;
+logic                                 cache_hit_upd;
 logic                                 cache_wr;
 logic                                 cache_line_wr;
 logic                                 cache_line_clean;
@@ -98,6 +100,7 @@ always_comb begin
     dcache2mem_req    = 1'b0;
     dcache2mem_wr     = 1'b0;
     cache_wrb_req     = 1'b0;
+    cache_hit_upd     = 1'b0;
     cache_line_wr     = 1'b0;
     cache_line_clean  = 1'b0;
     cache_wr          = 1'b0;
@@ -120,6 +123,7 @@ always_comb begin
 
             if (dcache_hit) begin 
             // In case of hit, perform the cache read/write operation   
+                cache_hit_upd = 1'b1;
                        
                 if (lsummu2dcache_wr_ff) begin
                     cache_wr      = 1'b1;
@@ -162,11 +166,9 @@ always_comb begin
             if (mem2dcache_ack_i) begin  
               //  dcache_state_next = DCACHE_ALLOCATE;
                 if (dcache_flush_i) begin
+                    // The same set is checked again for the remaining dirty ways
                     dcache_state_next = DCACHE_FLUSH_NEXT; // DCACHE_FLUSH;
                     cache_line_clean  = 1'b1;
-                    if (~(&evict_index_ff)) begin  // evict_index_ff < DCACHE_MAX_IDX
-                        evict_index_next  = evict_index_ff + 1;
-                    end
                 end else begin
                     dcache_state_next = DCACHE_ALLOCATE;
                     dcache2mem_req    = 1'b1;
@@ -223,6 +225,7 @@ end
 
 
 assign cache_wrb_req_o  = cache_wrb_req;
+assign cache_hit_upd_o  = cache_hit_upd;
 assign cache_wr_o       = cache_wr;
 assign cache_line_wr_o  = cache_line_wr;
 assign cache_line_clean_o  = cache_line_clean;
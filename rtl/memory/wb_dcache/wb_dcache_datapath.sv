@@ -23,6 +23,7 @@ module wb_dcache_datapath(
     input  wire                            cache_line_wr_i,
     input  wire                            cache_line_clean_i,
     input  wire                            cache_wrb_req_i,
+    input  wire                            cache_hit_upd_i,
     input  wire [DCACHE_IDX_BITS-1:0]      evict_index_i,
     output logic                           cache_hit_o,
     output logic                           cache_evict_req_o,
@@ -44,7 +45,8 @@ module wb_dcache_datapath(
 
 
 type_dcache_data_s                   cache_line_read, cache_line_write, cache_wdata;
-type_dcache_tag_s                    cache_tag_read, cache_tag_write;
+type_dcache_data_s                   cache_line_evict;
+type_dcache_tag_s                    cache_tag_evict, cache_tag_write;
 
 logic [DCACHE_DATA_WIDTH-1:0]        cache_word_read, cache_word_write;
 logic [DCACHE_DATA_WIDTH-1:0]        lsummu2dcache_wdata;
@@ -53,6 +55,23 @@ logic [15:0]                         cache_line_sel_byte, cache_data_wr_sel;
 logic [3:0]                          sel_byte;
 logic [3:0]                          cache_tag_wr_sel;
 
+// Set associativity related signal definitions
+type_dcache_data_s                   cache_line_read_way[DCACHE_NO_OF_WAYS];
+type_dcache_tag_s                    cache_tag_read_way[DCACHE_NO_OF_WAYS];
+logic [15:0]                         cache_data_wr_sel_way[DCACHE_NO_OF_WAYS];
+logic [3:0]                          cache_tag_wr_sel_way[DCACHE_NO_OF_WAYS];
+logic [DCACHE_NO_OF_WAYS-1:0]        cache_hit_way;
+logic [DCACHE_NO_OF_WAYS-1:0]        cache_valid_way;
+logic [DCACHE_NO_OF_WAYS-1:0]        cache_dirty_way;
+logic [DCACHE_WAY_BITS-1:0]          hit_way, victim_way, flush_way, evict_way;
+
+// Tree pseudo-LRU state, one bit per tree node of each set
+localparam PLRU_BITS = (DCACHE_NO_OF_WAYS > 1) ? DCACHE_NO_OF_WAYS-1 : 1;
+
+logic [PLRU_BITS-1:0]                plru_ff[DCACHE_NO_OF_SETS];
+logic [PLRU_BITS-1:0]                plru_hit_next, plru_fill_next;
+logic [DCACHE_WAY_BITS-1:0]          plru_victim_way;
+
 logic [DCACHE_DATA_WIDTH-1:0]        dcache2lsummu_data_ff, dcache2lsummu_data_next;
 logic [DCACHE_TAG_BITS-1:0]          addr_tag, addr_tag_ff;
 logic [1:0]                          addr_offset, addr_offset_ff;
@@ -60,7 +79,6 @@ logic [DCACHE_IDX_BITS-1:0]          addr_index;
 logic [DCACHE_IDX_BITS-1:0]          addr_index_ff;
 logic [DCACHE_IDX_BITS-1:0]          evict_index;
 logic                                dcache_flush;  
-logic  valid;                             
 
 assign dcache_flush         = dcache_flush_i;
 assign evict_index          = evict_index_i;
@@ -162,10 +180,109 @@ cache_tag_wr_sel = '0;
     end
 end
 
+// Parallel tag compare of all the ways
+for (genvar way = 0; way < DCACHE_NO_OF_WAYS; way++) begin : gen_hit_way
+    assign cache_valid_way[way] = cache_tag_read_way[way].valid;
+    assign cache_dirty_way[way] = cache_tag_read_way[way].dirty[0];
+    assign cache_hit_way[way]   = cache_valid_way[way] &&
+                                  (addr_tag_ff == cache_tag_read_way[way].tag[DCACHE_TAG_BITS-1:0]);
+end
+
+// Select the read cache data line of the hit way, at most one way hits
+always_comb begin
+    cache_line_read = '0;
+    hit_way         = '0;
+    for (int unsigned way = 0; way < DCACHE_NO_OF_WAYS; way++) begin
+        if (cache_hit_way[way]) begin
+            cache_line_read = cache_line_read | cache_line_read_way[way];
+            hit_way         = hit_way | DCACHE_WAY_BITS'(way);
+        end
+    end
+end
+
+// Replacement way on a miss, the first invalid way of the set or else the pseudo-LRU way.
+// The tags and the replacement state do not change until the line is allocated, so the 
+// same way is selected for the writeback and the allocation.
+always_comb begin
+    victim_way = plru_victim_way;
+    for (int way = DCACHE_NO_OF_WAYS-1; way >= 0; way--) begin
+        if (~cache_valid_way[way]) begin
+            victim_way = DCACHE_WAY_BITS'(way);
+        end
+    end
+end
+
+// During flush the dirty ways of a set are written back one at a time
+always_comb begin
+    flush_way = '0;
+    for (int way = DCACHE_NO_OF_WAYS-1; way >= 0; way--) begin
+        if (cache_dirty_way[way]) begin
+            flush_way = DCACHE_WAY_BITS'(way);
+        end
+    end
+end
+
+assign evict_way        = dcache_flush ? flush_way : victim_way;
+assign cache_line_evict = cache_line_read_way[evict_way];
+assign cache_tag_evict  = cache_tag_read_way[evict_way];
+
+// Write enables of the ways, a store updates the hit way, a line is allocated in the 
+// replacement way and flush cleans the way being written back
+always_comb begin
+    for (int unsigned way = 0; way < DCACHE_NO_OF_WAYS; way++) begin
+        cache_data_wr_sel_way[way] = '0;
+        cache_tag_wr_sel_way[way]  = '0;
+        if (cache_line_clean_i) begin
+            cache_tag_wr_sel_way[way]  = (evict_way == DCACHE_WAY_BITS'(way)) ? cache_tag_wr_sel : '0;
+        end else if (cache_wr_i) begin
+            cache_data_wr_sel_way[way] = (hit_way == DCACHE_WAY_BITS'(way)) ? cache_data_wr_sel : '0;
+            cache_tag_wr_sel_way[way]  = (hit_way == DCACHE_WAY_BITS'(way)) ? cache_tag_wr_sel : '0;
+        end else if (cache_line_wr_i) begin
+            cache_data_wr_sel_way[way] = (victim_way == DCACHE_WAY_BITS'(way)) ? cache_data_wr_sel : '0;
+            cache_tag_wr_sel_way[way]  = (victim_way == DCACHE_WAY_BITS'(way)) ? cache_tag_wr_sel : '0;
+        end
+    end
+end
+
+// The pseudo-LRU state of a set is updated on a hit and on the allocation of a line
+if (DCACHE_NO_OF_WAYS > 1) begin : gen_plru
+    plru_tree #(
+      .WAYS               (DCACHE_NO_OF_WAYS)
+    ) plru_tree_hit (
+      .plru_i             (plru_ff[addr_index_ff]),
+      .access_way_i       (hit_way),
+      .plru_o             (plru_hit_next),
+      .victim_way_o       (plru_victim_way)
+    );
+
+    plru_tree #(
+      .WAYS               (DCACHE_NO_OF_WAYS)
+    ) plru_tree_fill (
+      .plru_i             (plru_ff[addr_index_ff]),
+      .access_way_i       (victim_way),
+      .plru_o             (plru_fill_next),
+      .victim_way_o       ()
+    );
+end else begin : gen_no_plru
+    assign plru_hit_next   = '0;
+    assign plru_fill_next  = '0;
+    assign plru_victim_way = '0;
+end
+
+always_ff @(posedge clk) begin
+    if (!rst_n) begin
+        plru_ff <= '{default: '0};
+    end else if (cache_line_wr_i) begin
+        plru_ff[addr_index_ff] <= plru_fill_next;
+    end else if (cache_hit_upd_i) begin
+        plru_ff[addr_index_ff] <= plru_hit_next;
+    end
+end
+
 // Prepare address and data signals for cache-line writeback or allocate on cache miss 
 always_comb begin
     if (cache_wrb_req_i) begin
-        dcache2mem_addr = {cache_tag_read.tag[DCACHE_TAG_BITS-1:0], addr_index, {{DCACHE_OFFSET_BITS}{1'b0}}};
+        dcache2mem_addr = {cache_tag_evict.tag[DCACHE_TAG_BITS-1:0], addr_index, {{DCACHE_OFFSET_BITS}{1'b0}}};
     end else begin
         dcache2mem_addr = lsummu2dcache_addr_i;
     end
@@ -193,15 +310,17 @@ always_ff@(posedge clk) begin
   end
 end
 
+for (genvar way = 0; way < DCACHE_NO_OF_WAYS; way++) begin : gen_way
+
 dcache_data_ram dcache_data_ram_module (
   .clk                  (clk), 
   .rst_n                (rst_n),
 
   .req                  (lsummu2dcache_req_i),
-  .wr_en                (cache_data_wr_sel),
+  .wr_en                (cache_data_wr_sel_way[way]),
   .addr                 (addr_index),
   .wdata                (cache_wdata),
-  .rdata                (cache_line_read)  
+  .rdata                (cache_line_read_way[way])  
 );
 
 
@@ -210,30 +329,24 @@ dcache_tag_ram dcache_tag_ram_module (
   .rst_n                (rst_n),
 
   .req                  (lsummu2dcache_req_i),
-  .wr_en                (cache_tag_wr_sel),
+  .wr_en                (cache_tag_wr_sel_way[way]),
   .addr                 (addr_index),
   .wdata                (cache_tag_write),
-  .rdata                (cache_tag_read)  ,
+  .rdata                (cache_tag_read_way[way])  ,
   .dcache_flush         (dcache_flush)
 );
-always_comb begin
-    if (cache_tag_read.valid)begin
-	valid=1;
-    end else begin
-	valid=0;
-    end
+
 end
     
     
-    
 // Output signals update
 assign dcache2lsummu_data_next = cache_word_read;   // Read data from cache to LSU/MMU 
 
 
-assign cache_hit_o          = (addr_tag_ff == cache_tag_read.tag[DCACHE_TAG_BITS-1:0]) && valid;
-assign cache_evict_req_o    = cache_tag_read.dirty[0]; // & cache_tag_read.valid;
+assign cache_hit_o          = |cache_hit_way;
+assign cache_evict_req_o    = cache_tag_evict.dirty[0]; // & cache_tag_evict.valid;
 assign dcache2mem_addr_o    = dcache2mem_addr;
-assign dcache2mem_data_o    = cache_line_read;
+assign dcache2mem_data_o    = cache_line_evict;
 assign dcache2lsummu_data_o = dcache2lsummu_data_next;
 
 endmodule
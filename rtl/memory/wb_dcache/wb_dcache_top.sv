@@ -38,6 +38,7 @@ logic                              cache_wr;
 logic                              cache_line_wr;
 logic                              cache_line_clean;
 logic                              cache_wrb_req;
+logic                              cache_hit_upd;
 logic [DCACHE_IDX_BITS-1:0]        evict_index;
 
 type_lsummu2dcache_s               lsummu2dcache;
@@ -63,6 +64,7 @@ wb_dcache_controller wb_dcache_controller_module(
   .cache_line_wr_o         (cache_line_wr),
   .cache_line_clean_o      (cache_line_clean),
   .cache_wrb_req_o         (cache_wrb_req),
+  .cache_hit_upd_o         (cache_hit_upd),
 
   // LSU/MMU <---> data cache signals
   .lsummu2dcache_req_i     (lsummu2dcache.req),
@@ -89,6 +91,7 @@ wb_dcache_datapath wb_dcache_datapath_module(
   .cache_line_wr_i         (cache_line_wr),
   .cache_line_clean_i      (cache_line_clean),
   .cache_wrb_req_i         (cache_wrb_req), 
+  .cache_hit_upd_i         (cache_hit_upd),
   .evict_index_i           (evict_index),   
   .cache_hit_o             (cache_hit),
   .cache_evict_req_o       (cache_evict_req),
@@ -55,6 +55,12 @@ logic                                   mtimecmp_hi_wr_flag;
 logic                                   timer_overflow_ff, timer_overflow_next;
 type_clint2csr_s                        clint2csr;
 
+`ifdef VERILATOR
+// Idle cycles skipped by the testbench in wfi fast-forward mode, it is 
+// set for a single cycle by bench/pcore_tb.sv and is zero otherwise
+logic [63:0]                            sim_skip_cycles;
+`endif
+
 	
 //============================ Memory mapped timer register read operations =============================//
 always_comb begin
@@ -108,6 +114,9 @@ always_comb begin
 
     mtime_next = mtime_ff + 1'b1;
   //  mtime_next = mtime_ff;
+`ifdef VERILATOR
+    mtime_next = mtime_next + sim_skip_cycles;
+`endif
 
     if (mtime_lo_wr_flag) begin
         mtime_next[31:0] = w_data;
@@ -80,6 +80,7 @@ type_dbus2lsu_s                         dbus2lsu;
 
 type_dbus2peri_s                        dbus2peri;
 type_pipe2csr_s                         core2pipe;
+type_mem2hpm_s                          mem2hpm;
 
 
 type_clint2csr_s                        clint2csr;
@@ -94,6 +95,7 @@ logic                                   spi_sel;
 
 logic                                   dcache_flush;
 logic                                   lsu_flush;
+logic                                   sbuf_empty;
  
 
 // IRQ ignals
@@ -136,12 +138,15 @@ core_top core_top_module (
     .lsu2dbus_o          (lsu2dbus),       // Signal to data bus 
     .dbus2lsu_i          (dbus2lsu),
     .dcache_flush_o      (dcache_flush),
-   // .lsu_flush_o         (lsu_flush),
+    .lsu_flush_o         (lsu_flush),
 
     .clint2csr_i         (clint2csr),
 
     // IRQ lines
-    .core2pipe_i         (core2pipe)
+    .core2pipe_i         (core2pipe),
+
+    // Performance monitor events
+    .mem2hpm_i           (mem2hpm)
     
     // , .debug_port_i        (debug_port_i)
 );
@@ -155,6 +160,7 @@ dbus_interconnect dbus_interconnect_module (
     .lsu2dbus_i            (lsu2dbus),
     .dbus2lsu_o            (dbus2lsu),
     .dcache_flush_i        (dcache_flush),
+    .sbuf_empty_i          (sbuf_empty),
 
     // Peripheral (data memory and GPIO) selection signals
     .dmem_sel_o            (dmem_sel),
@@ -228,6 +234,7 @@ mem_top mem_top_module (
     .bmem2dbus_o          (bmem2dbus),
     .dcache_flush_i       (dcache_flush),
     .lsu_flush_i          (lsu_flush),
+    .sbuf_empty_o         (sbuf_empty),
 
    // MMU <---> data cache interface signals 
     .mmu2dcache_i         (mmu2dcache),
@@ -242,7 +249,9 @@ mem_top mem_top_module (
    // Instruction memory interface signals 
     .if2icache_i          (if2icache),
     .bmem_sel_i           (bmem_sel),
-    .icache2if_o          (icache2if)
+    .icache2if_o          (icache2if),
+
+    .mem2hpm_o            (mem2hpm)
 );
 
 spi_top spi_top_module (
@@ -0,0 +1,119 @@
+/*********************************************************************
+ * Filename :    perf.c
+ *
+ * Description:  Reads the 64-bit mcycle and minstret counters around
+ *               the measured part of a benchmark and prints the
+ *               difference on the UART. mhpmcounter3 and 4 count the
+ *               resolved and the mispredicted branches and jumps, 5
+ *               and 6 the returns predicted from the return address
+ *               stack and the ones among them that were mispredicted
+ *********************************************************************/
+
+#include <stdint.h>
+
+#include "uart.h"
+#include "perf.h"
+
+static uint64_t perf_cycle_start, perf_cycle_stop;
+static uint64_t perf_instret_start, perf_instret_stop;
+static uint64_t perf_branch_start, perf_branch_stop;
+static uint64_t perf_mispredict_start, perf_mispredict_stop;
+static uint64_t perf_ret_start, perf_ret_stop;
+static uint64_t perf_ret_mispredict_start, perf_ret_mispredict_stop;
+
+// mhpmevent selectors, see type_hpm_event_e in rtl/defines/pcore_csr_defs.svh
+#define HPM_EVENT_BRANCH_FLUSH  7
+#define HPM_EVENT_BRANCH        11
+#define HPM_EVENT_RET           12
+#define HPM_EVENT_RET_FLUSH     13
+
+// The high half is read again to detect a carry between the two reads
+#define PERF_READ_CSR64(lo, hi)                                     \
+  ({                                                                \
+    uint32_t h, l, h2;                                              \
+    do {                                                            \
+      asm volatile ("csrr %0, " #hi : "=r"(h));                     \
+      asm volatile ("csrr %0, " #lo : "=r"(l));                     \
+      asm volatile ("csrr %0, " #hi : "=r"(h2));                    \
+    } while (h != h2);                                              \
+    ((uint64_t)h << 32) | l;                                        \
+  })
+
+void perf_start(void) {
+  asm volatile ("csrw mhpmevent3, %0" :: "r"(HPM_EVENT_BRANCH));
+  asm volatile ("csrw mhpmevent4, %0" :: "r"(HPM_EVENT_BRANCH_FLUSH));
+  asm volatile ("csrw mhpmevent5, %0" :: "r"(HPM_EVENT_RET));
+  asm volatile ("csrw mhpmevent6, %0" :: "r"(HPM_EVENT_RET_FLUSH));
+  perf_branch_start     = PERF_READ_CSR64(mhpmcounter3, mhpmcounter3h);
+  perf_mispredict_start = PERF_READ_CSR64(mhpmcounter4, mhpmcounter4h);
+  perf_ret_start        = PERF_READ_CSR64(mhpmcounter5, mhpmcounter5h);
+  perf_ret_mispredict_start = PERF_READ_CSR64(mhpmcounter6, mhpmcounter6h);
+  perf_instret_start    = PERF_READ_CSR64(minstret, minstreth);
+  perf_cycle_start      = PERF_READ_CSR64(mcycle, mcycleh);
+}
+
+void perf_stop(void) {
+  perf_cycle_stop       = PERF_READ_CSR64(mcycle, mcycleh);
+  perf_instret_stop     = PERF_READ_CSR64(minstret, minstreth);
+  perf_mispredict_stop  = PERF_READ_CSR64(mhpmcounter4, mhpmcounter4h);
+  perf_branch_stop      = PERF_READ_CSR64(mhpmcounter3, mhpmcounter3h);
+  perf_ret_stop         = PERF_READ_CSR64(mhpmcounter5, mhpmcounter5h);
+  perf_ret_mispredict_stop = PERF_READ_CSR64(mhpmcounter6, mhpmcounter6h);
+}
+
+uint64_t perf_cycles(void) {
+  return perf_cycle_stop - perf_cycle_start;
+}
+
+uint64_t perf_instret(void) {
+  return perf_instret_stop - perf_instret_start;
+}
+
+uint64_t perf_branches(void) {
+  return perf_branch_stop - perf_branch_start;
+}
+
+uint64_t perf_mispredicts(void) {
+  return perf_mispredict_stop - perf_mispredict_start;
+}
+
+uint64_t perf_returns(void) {
+  return perf_ret_stop - perf_ret_start;
+}
+
+uint64_t perf_ret_mispredicts(void) {
+  return perf_ret_mispredict_stop - perf_ret_mispredict_start;
+}
+
+void perf_print(const char *s) {
+  while (*s)
+    Uetrv32_Uart_Tx((uint32_t)*s++);
+}
+
+void perf_print_u64(uint64_t value) {
+  char buffer[21];
+  int  pos = sizeof(buffer) - 1;
+
+  buffer[pos] = '\0';
+  do {
+    buffer[--pos] = '0' + (value % 10);
+    value /= 10;
+  } while (value);
+  perf_print(&buffer[pos]);
+}
+
+void perf_report(void) {
+  perf_print("cycles=");
+  perf_print_u64(perf_cycles());
+  perf_print(" instret=");
+  perf_print_u64(perf_instret());
+  perf_print(" branches=");
+  perf_print_u64(perf_branches());
+  perf_print(" mispredicts=");
+  perf_print_u64(perf_mispredicts());
+  perf_print(" returns=");
+  perf_print_u64(perf_returns());
+  perf_print(" ret_mispredicts=");
+  perf_print_u64(perf_ret_mispredicts());
+  perf_print("\n");
+}
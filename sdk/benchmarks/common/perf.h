@@ -0,0 +1,29 @@
+/*********************************************************************
+ * Filename :    perf.h
+ *
+ * Description:  Cycle and retired instruction counts of the measured
+ *               part of a benchmark. perf_report() prints them on the
+ *               UART as "cycles=<N> instret=<N> branches=<N>
+ *               mispredicts=<N> returns=<N> ret_mispredicts=<N>", the
+ *               line parsed by bench/perf_regression.py
+ *********************************************************************/
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+
+void     perf_start(void);
+void     perf_stop(void);
+uint64_t perf_cycles(void);
+uint64_t perf_instret(void);
+uint64_t perf_branches(void);
+uint64_t perf_mispredicts(void);
+uint64_t perf_returns(void);
+uint64_t perf_ret_mispredicts(void);
+void     perf_report(void);
+
+void     perf_print(const char *s);
+void     perf_print_u64(uint64_t value);
+
+#endif // PERF_H
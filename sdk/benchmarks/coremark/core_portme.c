@@ -0,0 +1,186 @@
+/*********************************************************************
+ * Filename :    core_portme.c
+ *
+ * Description:  CoreMark port for UETRV-PCore. The timed iterations are
+ *               measured with mcycle/minstret, the counts and the
+ *               resulting CoreMark/MHz are printed after the CoreMark
+ *               report
+ *********************************************************************/
+
+#include <stdarg.h>
+
+#include "coremark.h"
+#include "uart.h"
+#include "perf.h"
+
+#if VALIDATION_RUN
+volatile ee_s32 seed1_volatile = 0x3415;
+volatile ee_s32 seed2_volatile = 0x3415;
+volatile ee_s32 seed3_volatile = 0x66;
+#endif
+#if PERFORMANCE_RUN
+volatile ee_s32 seed1_volatile = 0x0;
+volatile ee_s32 seed2_volatile = 0x0;
+volatile ee_s32 seed3_volatile = 0x66;
+#endif
+#if PROFILE_RUN
+volatile ee_s32 seed1_volatile = 0x8;
+volatile ee_s32 seed2_volatile = 0x8;
+volatile ee_s32 seed3_volatile = 0x8;
+#endif
+volatile ee_s32 seed4_volatile = ITERATIONS;
+volatile ee_s32 seed5_volatile = 0;
+
+ee_u32 default_num_contexts = 1;
+
+//================================== Timing ==================================//
+
+void start_time(void) {
+    perf_start();
+}
+
+void stop_time(void) {
+    perf_stop();
+}
+
+CORE_TICKS get_time(void) {
+    return (CORE_TICKS)perf_cycles();
+}
+
+secs_ret time_in_secs(CORE_TICKS ticks) {
+    return (secs_ret)ticks / (secs_ret)CPU_CLOCK_HZ;
+}
+
+//============================= Initialization ==============================//
+
+void portable_init(core_portable *p, int *argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    Uetrv32_Uart_Init(UART_BAUD_DIV);
+
+    if (sizeof(ee_ptr_int) != sizeof(ee_u8 *)) {
+        ee_printf("ERROR! Please define ee_ptr_int to a type that holds a pointer!\n");
+    }
+    if (sizeof(ee_u32) != 4) {
+        ee_printf("ERROR! Please define ee_u32 to a 32b unsigned type!\n");
+    }
+    p->portable_id = 1;
+}
+
+// CoreMark/MHz with three decimals from the cycles of the timed iterations
+void portable_fini(core_portable *p) {
+    uint64_t cycles = perf_cycles();
+    uint64_t score  = cycles ? ((uint64_t)ITERATIONS * 1000000000ull) / cycles : 0;
+
+    ee_printf("CoreMark/MHz     : %u.%03u\n", (unsigned)(score / 1000), (unsigned)(score % 1000));
+    perf_report();
+    p->portable_id = 0;
+}
+
+//================================ ee_printf ================================//
+
+// Formats the subset used by CoreMark: %d %i %u %x %X %c %s %% with the
+// '-' and '0' flags, a field width and the 'l' length modifier
+static int ee_putc(char c) {
+    Uetrv32_Uart_Tx((uint32_t)c);
+    return 1;
+}
+
+static int ee_pad(int count, char pad) {
+    int n = 0;
+    while (count-- > 0)
+        n += ee_putc(pad);
+    return n;
+}
+
+int ee_printf(const char *fmt, ...) {
+    va_list args;
+    int     n = 0;
+
+    va_start(args, fmt);
+    for (; *fmt; fmt++) {
+        if (*fmt != '%') {
+            n += ee_putc(*fmt);
+            continue;
+        }
+
+        int  left  = 0;
+        char pad   = ' ';
+        int  width = 0;
+
+        for (fmt++; (*fmt == '-') || (*fmt == '0'); fmt++) {
+            if (*fmt == '-')
+                left = 1;
+            else
+                pad  = '0';
+        }
+        while ((*fmt >= '0') && (*fmt <= '9'))
+            width = width * 10 + (*fmt++ - '0');
+        while (*fmt == 'l')
+            fmt++;
+
+        char        digits[12];
+        const char *str = digits;
+        int         len = 0;
+        int         neg = 0;
+
+        switch (*fmt) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X': {
+                unsigned int value = va_arg(args, unsigned int);
+                unsigned int base  = ((*fmt == 'x') || (*fmt == 'X')) ? 16 : 10;
+                const char  *hex   = (*fmt == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+
+                if (((*fmt == 'd') || (*fmt == 'i')) && ((int)value < 0)) {
+                    neg   = 1;
+                    value = -value;
+                }
+                len = sizeof(digits);
+                do {
+                    digits[--len] = hex[value % base];
+                    value /= base;
+                } while (value);
+                str = &digits[len];
+                len = sizeof(digits) - len;
+                break;
+            }
+            case 'c':
+                digits[0] = (char)va_arg(args, int);
+                len = 1;
+                break;
+            case 's':
+                str = va_arg(args, const char *);
+                if (!str)
+                    str = "(null)";
+                while (str[len])
+                    len++;
+                break;
+            case '\0':
+                fmt--;
+                continue;
+            default:
+                digits[0] = *fmt;
+                len = 1;
+                break;
+        }
+
+        // The sign goes before zero padding and after space padding
+        if (neg && (pad == '0'))
+            n += ee_putc('-');
+        if (!left)
+            n += ee_pad(width - len - neg, pad);
+        if (neg && (pad != '0'))
+            n += ee_putc('-');
+        for (int i = 0; i < len; i++)
+            n += ee_putc(str[i]);
+        if (left)
+            n += ee_pad(width - len - neg, ' ');
+    }
+    va_end(args);
+
+    return n;
+}
@@ -0,0 +1,26 @@
+/*********************************************************************
+ * Filename :    boardsupport.c
+ *
+ * Description:  Embench-IoT board support for UETRV-PCore. The trigger
+ *               functions bracket the timed benchmark body, its cycle
+ *               and instruction counts are printed on the UART
+ *********************************************************************/
+
+#include <stdint.h>
+
+#include "support.h"
+#include "uart.h"
+#include "perf.h"
+
+void initialise_board(void) {
+  Uetrv32_Uart_Init(UART_BAUD_DIV);
+}
+
+void __attribute__ ((noinline)) start_trigger(void) {
+  perf_start();
+}
+
+void __attribute__ ((noinline)) stop_trigger(void) {
+  perf_stop();
+  perf_report();
+}
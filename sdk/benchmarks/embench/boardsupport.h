@@ -0,0 +1,20 @@
+/*********************************************************************
+ * Filename :    boardsupport.h
+ *
+ * Description:  Embench-IoT board support for UETRV-PCore. CPU_MHZ
+ *               scales the iterations of each benchmark, 1 keeps the
+ *               simulation runs at a few million cycles
+ *********************************************************************/
+
+#ifndef BOARDSUPPORT_H
+#define BOARDSUPPORT_H
+
+#ifndef CPU_MHZ
+#define CPU_MHZ         1
+#endif
+
+#ifndef WARMUP_HEAT
+#define WARMUP_HEAT     1
+#endif
+
+#endif // BOARDSUPPORT_H
@@ -0,0 +1,94 @@
+/*********************************************************************
+ * Filename :    hpm_counters.c
+ *
+ * Description:  Reads back the hardware performance counters. A loop
+ *               with a known number of branches is counted by
+ *               mhpmcounter3, counting stops while its mcountinhibit
+ *               bit is set, the hpmcounter3 shadow reads the machine
+ *               counter and a load from an untouched line is counted
+ *               as a dcache miss by mhpmcounter4. The exit code is the
+ *               mask of the failed checks, 0 when all of them pass
+ *********************************************************************/
+
+#include <stdint.h>
+
+#include "uart.h"
+#include "perf.h"
+
+// mhpmevent selectors, see type_hpm_event_e in rtl/defines/pcore_csr_defs.svh
+#define HPM_EVENT_DCACHE_MISS   2
+#define HPM_EVENT_BRANCH        11
+
+#define LOOP_BRANCHES           100
+
+// Main memory well above the program, data and stack, never cached before
+#define UNTOUCHED_ADDR          0x82000000u
+
+#define HPM_FAIL_BRANCH         0x1
+#define HPM_FAIL_INHIBIT        0x2
+#define HPM_FAIL_SHADOW         0x4
+#define HPM_FAIL_DCACHE_MISS    0x8
+
+#define read_csr(csr)                                               \
+  ({                                                                \
+    uint32_t v;                                                     \
+    asm volatile ("csrr %0, " #csr : "=r"(v));                      \
+    v;                                                              \
+  })
+
+#define write_csr(csr, value) asm volatile ("csrw " #csr ", %0" :: "r"(value))
+
+// LOOP_BRANCHES conditional branches and no other branch or JALR
+static inline void branch_loop(void) {
+  uint32_t count = LOOP_BRANCHES;
+  asm volatile ("1: addi %0, %0, -1\n"
+                "   bnez %0, 1b" : "+r"(count));
+}
+
+static void hpm_print(const char *name, uint32_t value) {
+  perf_print(name);
+  perf_print_u64(value);
+}
+
+int main(void) {
+  uint32_t failed = 0;
+  uint32_t start, stop, machine, shadow;
+
+  Uetrv32_Uart_Init(UART_BAUD_DIV);
+
+  write_csr(mcountinhibit, 0);
+  write_csr(mhpmevent3, HPM_EVENT_BRANCH);
+  write_csr(mhpmevent4, HPM_EVENT_DCACHE_MISS);
+
+  // Every branch of the loop is resolved once
+  start = read_csr(mhpmcounter3);
+  branch_loop();
+  stop  = read_csr(mhpmcounter3);
+  hpm_print("hpm: branches=", stop - start);
+  if (stop - start != LOOP_BRANCHES)
+    failed |= HPM_FAIL_BRANCH;
+
+  // No counting while inhibited, the shadow then reads the same value
+  write_csr(mcountinhibit, 1u << 3);
+  start   = read_csr(mhpmcounter3);
+  branch_loop();
+  machine = read_csr(mhpmcounter3);
+  shadow  = read_csr(hpmcounter3);
+  write_csr(mcountinhibit, 0);
+  hpm_print(" inhibited=", machine - start);
+  if (machine != start)
+    failed |= HPM_FAIL_INHIBIT;
+  if (shadow != machine)
+    failed |= HPM_FAIL_SHADOW;
+
+  // The first load of a line that was never accessed refills it
+  start = read_csr(mhpmcounter4);
+  (void)*(volatile uint32_t *)UNTOUCHED_ADDR;
+  stop  = read_csr(mhpmcounter4);
+  hpm_print(" dcache_misses=", stop - start);
+  if (stop - start == 0)
+    failed |= HPM_FAIL_DCACHE_MISS;
+
+  perf_print(failed ? " FAIL\n" : " PASS\n");
+  return failed;
+}
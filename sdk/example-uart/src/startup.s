@@ -83,6 +83,16 @@ call_main:
   li   a1, 0
   call main
 
+# Pass the return value of main to the simulation exit register, the
+# testbench ends the simulation with it as exit code. The register only
+# exists in Verilator simulation, on the FPGA the store is never
+# acknowledged and stalls the core, so it is left out with make fpga=1
+.ifndef FPGA
+sim_exit:
+  li   t0, 0xA0000000
+  sw   a0, 0(t0)
+.endif
+
 # A 'default' interrupt handler, in case an interrupt triggers without its handler defined
 default_interrupt_handler:
   j default_interrupt_handler
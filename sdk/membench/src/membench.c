@@ -0,0 +1,245 @@
+/*********************************************************************
+ * Filename :    membench.c
+ *
+ * Description:  Memory latency and bandwidth at working set sizes from
+ *               1 KB up to MAX_KB, in the style of lmbench lat_mem_rd
+ *               and bw_mem. The latency is measured by chasing pointers
+ *               linked in a random order through one word of every
+ *               cache line, the bandwidth by reading, writing and
+ *               copying 32-bit words. All timing uses mcycle, so the
+ *               same image gives comparable figures in simulation and
+ *               on the FPGA board
+ *********************************************************************/
+
+#include <stdint.h>
+
+#include "uart.h"
+#include "perf.h"
+
+// Cache geometry, passed by the Makefile from rtl/defines
+#ifndef LINE_BYTES
+#define LINE_BYTES      16
+#endif
+#ifndef DCACHE_SETS
+#define DCACHE_SETS     2048
+#endif
+#ifndef DCACHE_WAYS
+#define DCACHE_WAYS     1
+#endif
+#ifndef ICACHE_SETS
+#define ICACHE_SETS     512
+#endif
+#ifndef ICACHE_WAYS
+#define ICACHE_WAYS     4
+#endif
+
+// Buffers start after the program image and end with main memory
+#ifndef BUFFER_BASE
+#define BUFFER_BASE     0x80100000u
+#endif
+#ifndef MEMORY_END
+#define MEMORY_END      0x84000000u
+#endif
+
+#ifndef MAX_KB
+#define MAX_KB          32768
+#endif
+
+// Minimum number of loads and bytes per measurement, small working sets
+// are traversed repeatedly
+#define MIN_LOADS       16384
+#define MIN_BYTES       (256 * 1024)
+
+#define UNROLL          8
+
+static uint32_t lcg_state = 1;
+
+static uint32_t lcg_next(void) {
+  lcg_state = lcg_state * 1664525u + 1013904223u;
+  return lcg_state;
+}
+
+//================================== Output ==================================//
+
+static void print_pad(const char *s, int width) {
+  int len = 0;
+  while (s[len])
+    len++;
+  while (width-- > len)
+    Uetrv32_Uart_Tx(' ');
+  perf_print(s);
+}
+
+static void print_u32(uint32_t value, int width) {
+  char buffer[11];
+  int  pos = sizeof(buffer) - 1;
+
+  buffer[pos] = '\0';
+  do {
+    buffer[--pos] = '0' + (value % 10);
+    value /= 10;
+  } while (value);
+  print_pad(&buffer[pos], width);
+}
+
+// Prints a value given in hundredths with two decimals
+static void print_fixed(uint64_t hundredths, int width) {
+  char     buffer[24];
+  int      pos = sizeof(buffer) - 1;
+  uint32_t frac = hundredths % 100;
+  uint64_t whole = hundredths / 100;
+
+  buffer[pos]   = '\0';
+  buffer[--pos] = '0' + (frac % 10);
+  buffer[--pos] = '0' + (frac / 10);
+  buffer[--pos] = '.';
+  do {
+    buffer[--pos] = '0' + (whole % 10);
+    whole /= 10;
+  } while (whole);
+  print_pad(&buffer[pos], width);
+}
+
+//================================= Latency =================================//
+
+// Links one word of every line in a random cyclic order (Sattolo's
+// algorithm), the shuffled line indices are kept in the third word
+static void **chase_init(uint8_t *base, uint32_t size) {
+  uint32_t lines = size / LINE_BYTES;
+
+  for (uint32_t i = 0; i < lines; i++)
+    ((uint32_t *)(base + i * LINE_BYTES))[2] = i;
+
+  for (uint32_t i = lines - 1; i > 0; i--) {
+    uint32_t *a = (uint32_t *)(base + i * LINE_BYTES) + 2;
+    uint32_t *b = (uint32_t *)(base + ((lcg_next() >> 8) % i) * LINE_BYTES) + 2;
+    uint32_t  t = *a;
+    *a = *b;
+    *b = t;
+  }
+
+  for (uint32_t i = 0; i < lines; i++) {
+    uint32_t from = ((uint32_t *)(base + i * LINE_BYTES))[2];
+    uint32_t to   = ((uint32_t *)(base + ((i + 1) % lines) * LINE_BYTES))[2];
+    *(void **)(base + from * LINE_BYTES) = base + to * LINE_BYTES;
+  }
+  return (void **)base;
+}
+
+static void ** __attribute__ ((noinline)) chase(void **p, uint32_t count) {
+  for (; count; count -= UNROLL) {
+    p = (void **)*p;  p = (void **)*p;  p = (void **)*p;  p = (void **)*p;
+    p = (void **)*p;  p = (void **)*p;  p = (void **)*p;  p = (void **)*p;
+  }
+  return p;
+}
+
+static volatile void *chase_sink;
+
+// Cycles per load in hundredths
+static uint64_t measure_latency(uint8_t *base, uint32_t size) {
+  uint32_t lines = size / LINE_BYTES;
+  uint32_t loads = (lines > MIN_LOADS) ? lines : MIN_LOADS;
+  void   **p     = chase_init(base, size);
+
+  loads = (loads + UNROLL - 1) / UNROLL * UNROLL;
+  p = chase(p, (lines + UNROLL - 1) / UNROLL * UNROLL);
+
+  perf_start();
+  p = chase(p, loads);
+  perf_stop();
+
+  chase_sink = p;
+  return perf_cycles() * 100 / loads;
+}
+
+//================================ Bandwidth ================================//
+
+static uint32_t __attribute__ ((noinline)) bw_read(const uint32_t *p, uint32_t words) {
+  uint32_t sum = 0;
+  for (const uint32_t *end = p + words; p != end; p += UNROLL)
+    sum += p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+  return sum;
+}
+
+static void __attribute__ ((noinline)) bw_write(uint32_t *p, uint32_t words, uint32_t value) {
+  for (uint32_t *end = p + words; p != end; p += UNROLL) {
+    p[0] = value;  p[1] = value;  p[2] = value;  p[3] = value;
+    p[4] = value;  p[5] = value;  p[6] = value;  p[7] = value;
+  }
+}
+
+static void __attribute__ ((noinline)) bw_copy(uint32_t *d, const uint32_t *s, uint32_t words) {
+  for (uint32_t *end = d + words; d != end; d += UNROLL, s += UNROLL) {
+    d[0] = s[0];  d[1] = s[1];  d[2] = s[2];  d[3] = s[3];
+    d[4] = s[4];  d[5] = s[5];  d[6] = s[6];  d[7] = s[7];
+  }
+}
+
+enum { BW_READ, BW_WRITE, BW_COPY };
+
+static volatile uint32_t bw_sink;
+
+// Bytes per cycle in hundredths, for copy the working set holds both the
+// source and the destination
+static uint64_t measure_bandwidth(int kernel, uint8_t *base, uint32_t size) {
+  uint32_t *buf    = (uint32_t *)base;
+  uint32_t  words  = size / 4;
+  uint32_t  passes = (size >= MIN_BYTES) ? 1 : MIN_BYTES / size;
+  uint32_t  sum    = 0;
+
+  if (kernel == BW_COPY)
+    words /= 2;
+
+  for (uint32_t pass = 0; pass <= passes; pass++) {
+    // The first pass warms up the caches
+    if (pass == 1)
+      perf_start();
+    switch (kernel) {
+      case BW_READ:  sum += bw_read(buf, words);            break;
+      case BW_WRITE: bw_write(buf, words, pass);            break;
+      case BW_COPY:  bw_copy(buf + words, buf, words);      break;
+    }
+  }
+  perf_stop();
+
+  bw_sink = sum;
+  return (uint64_t)size * passes * 100 / perf_cycles();
+}
+
+//=================================== Main ===================================//
+
+int main(void) {
+  uint8_t *base     = (uint8_t *)BUFFER_BASE;
+  uint32_t max_size = MAX_KB * 1024u;
+
+  // Largest power of two between the buffer base and the end of memory
+  while (max_size > (MEMORY_END - BUFFER_BASE))
+    max_size /= 2;
+
+  Uetrv32_Uart_Init(UART_BAUD_DIV);
+
+  perf_print("membench: dcache ");
+  print_u32(DCACHE_SETS * DCACHE_WAYS * LINE_BYTES / 1024, 0);
+  perf_print(" KB ");
+  print_u32(DCACHE_WAYS, 0);
+  perf_print("-way, icache ");
+  print_u32(ICACHE_SETS * ICACHE_WAYS * LINE_BYTES / 1024, 0);
+  perf_print(" KB ");
+  print_u32(ICACHE_WAYS, 0);
+  perf_print("-way, ");
+  print_u32(LINE_BYTES, 0);
+  perf_print(" B lines\n");
+  perf_print("   size KB  latency cyc/ld   read B/cyc  write B/cyc   copy B/cyc\n");
+
+  for (uint32_t size = 1024; size <= max_size; size *= 2) {
+    print_u32(size / 1024, 10);
+    print_fixed(measure_latency(base, size), 16);
+    print_fixed(measure_bandwidth(BW_READ, base, size), 13);
+    print_fixed(measure_bandwidth(BW_WRITE, base, size), 13);
+    print_fixed(measure_bandwidth(BW_COPY, base, size), 13);
+    perf_print("\n");
+  }
+
+  return 0;
+}
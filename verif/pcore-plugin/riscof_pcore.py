@@ -9,6 +9,7 @@
 #  *********************************************************************
 
 import os
+import re
 import logging
 
 import riscof.utils as utils
@@ -30,7 +31,8 @@ class pcore(pluginTemplate):
             raise SystemExit(1)
         
         self.dut_exe = os.path.join(config['PATH'] if 'PATH' in config else "","pcore")
-        self.num_jobs = str(config['jobs'] if 'jobs' in config else 1)
+        self.num_jobs = str(config['jobs'] if 'jobs' in config else os.cpu_count())
+        self.make = config['make'] if 'make' in config else 'make'
         self.pluginpath=os.path.abspath(config['pluginpath'])
         self.isa_spec = os.path.abspath(config['ispec'])
         self.platform_spec = os.path.abspath(config['pspec'])
@@ -51,26 +53,21 @@ class pcore(pluginTemplate):
        
        self.objcopy_cmd = 'riscv64-unknown-elf-objcopy -O binary {0} {1}.bin'
        self.objdump_cmd = 'riscv64-unknown-elf-objdump -D {0} > {1}.disasm'
-       self.hexgen_cmd  = 'python3 makehex.py {0}/{1}.bin > {0}/{1}.hex'
+       self.hexgen_cmd  = 'python3 '+os.path.abspath('makehex.py')+' {0}.bin > {0}.hex'
 
        # build simulation model
        self.toplevel = 'pcore_tb'
        self.buidldir = 'sim_work'
-       comp_pcore = 'verilator --Mdir {0} +define+COMPLIANCE=1 -cc \
-        $(find ../rtl/ -type f -name "*v")\
-        ../bench/{1}.sv  \
-        -Wno-TIMESCALEMOD -Wno-MULTIDRIVEN -Wno-CASEOVERLAP \
-        -Wno-WIDTH -Wno-UNOPTFLAT -Wno-IMPLICIT -Wno-PINMISSING \
-        -I../rtl/defines/ --top-module {1} \
-        --exe ../bench/pcore_tb.cpp --trace --trace-structs'.format(self.buidldir, self.toplevel)
-       utils.shellCommand(comp_pcore).run()
-       build_pcore = 'make -C {0} -f V{1}.mk'.format(self.buidldir, self.toplevel)
+       # The model is built by the top level Makefile so the RTL and
+       # testbench source lists are the same as for make verilate
+       build_pcore = '{0} -C .. verilate defines=COMPLIANCE=1 ver-library=verif/{1}'.format(self.make, self.buidldir)
        utils.shellCommand(build_pcore).run()
 
-       # Simulate
-       self.sim_pcore = './{0}/V{1} \
+       # Simulate, each test runs in its own work directory and writes
+       # the signature there
+       self.sim_pcore = os.path.abspath(self.buidldir)+'/V'+self.toplevel+' \
         +max_cycles=1000000 \
-        +imem={2}/{3}.hex'
+        +imem={0}.hex +signature={1} > {2}'
 
     def build(self, isa_yaml, platform_yaml):
 
@@ -95,6 +92,13 @@ class pcore(pluginTemplate):
       self.compile_cmd = self.compile_cmd+' -mabi='+('lp64 ' if 64 in ispec['supported_xlen'] else 'ilp32 ')
 
     def runTests(self, testList):
+      # Tests are independent, they are compiled and simulated as make
+      # targets run in parallel by num_jobs workers
+      if os.path.exists(self.work_dir+ "/Makefile." + self.name[:-1]):
+          os.remove(self.work_dir+ "/Makefile." + self.name[:-1])
+      make = utils.makeUtil(makefilePath=os.path.join(self.work_dir, "Makefile." + self.name[:-1]))
+      make.makeCommand = self.make + ' -j' + self.num_jobs
+
       for testname in testList:
           testentry  = testList[testname]
           test       = testentry['test_path']
@@ -104,27 +108,44 @@ class pcore(pluginTemplate):
           elf            = '{0}.elf'.format(file_name)
           compile_macros = ' -D' + " -D".join(testentry['macros'])
           marchstr = testentry['isa'].lower()
-          compile_run    = self.compile_cmd.format(marchstr, test, elf, compile_macros)
-          utils.shellCommand(compile_run).run(cwd=test_dir)
-
-          objcopy_run    = self.objcopy_cmd.format(elf,file_name)
-          utils.shellCommand(objcopy_run).run(cwd=test_dir)
-
-          objdump_run    = self.objdump_cmd.format(elf,file_name)
-          utils.shellCommand(objdump_run).run(cwd=test_dir)
+          sig_file = os.path.join(test_dir, self.name[:-1] + ".signature")
 
-          hexgen_run     = self.hexgen_cmd.format(test_dir,file_name)
-          utils.shellCommand(hexgen_run).run()
+          execute  = '@cd '+test_dir+';'
+          execute += self.compile_cmd.format(marchstr, test, elf, compile_macros)+';'
+          execute += self.objcopy_cmd.format(elf,file_name)+';'
+          execute += self.objdump_cmd.format(elf,file_name)+';'
+          execute += self.hexgen_cmd.format(file_name)+';'
+          execute += self.sim_pcore.format(file_name, sig_file, file_name+'.log')+';'
+          make.add_target(execute)
 
-          run_sim        = self.sim_pcore.format(self.buidldir,self.toplevel,test_dir,file_name)
-          utils.shellCommand(run_sim).run()
-          
-          cp_sig = 'cp -f *.signature {0}/.'.format(test_dir)
-          utils.shellCommand(cp_sig).run()
-
-      utils.shellCommand('rm *.signature').run()
+      make.execute_all(self.work_dir)
+      self.report(testList)
 
       if not self.target_run:
           raise SystemExit
 
-    
+    def report(self, testList):
+      # Cycle count and simulation wall time of each test, taken from the
+      # speed report printed by the testbench
+      speed = re.compile(r'Simulated (\d+) cycles in ([\d.]+) s')
+      report_file = os.path.join(self.work_dir, 'pcore_tests.txt')
+      total_cycles = 0
+      total_secs = 0.0
+      with open(report_file, 'w') as report:
+          report.write('{0:<60} {1:>12} {2:>10}\n'.format('test', 'cycles', 'time (s)'))
+          for testname in testList:
+              log = os.path.join(testList[testname]['work_dir'], 'pcore.log')
+              match = None
+              if os.path.exists(log):
+                  with open(log) as f:
+                      match = speed.search(f.read())
+              name = os.path.basename(testList[testname]['test_path'])
+              if match:
+                  total_cycles += int(match.group(1))
+                  total_secs += float(match.group(2))
+                  report.write('{0:<60} {1:>12} {2:>10}\n'.format(name, match.group(1), match.group(2)))
+              else:
+                  report.write('{0:<60} {1:>12} {2:>10}\n'.format(name, '-', '-'))
+          report.write('{0:<60} {1:>12} {2:>10.2f}\n'.format('total', total_cycles, total_secs))
+      logger.info('Pcore cycle counts and simulation times written to ' + report_file)
+